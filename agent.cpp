@@ -0,0 +1,225 @@
+#include "agent.h"
+
+// Shortest signed distance from a to b on a ring of size n
+static int wrap_delta(int a, int b, int n) {
+    int d = b - a;
+    if (d > n / 2) d -= n;
+    if (d < -n / 2) d += n;
+    return d;
+}
+
+// GreedyAgent class implementation
+char GreedyAgent::chooseMove(const SnakeEngine& engine) {
+    const DynamicBoard& board = engine.getBoard();
+    auto head = engine.getHead();
+    auto food = engine.getFood();
+    int dr = wrap_delta(head.first, food.first, board.height());
+    int dc = wrap_delta(head.second, food.second, board.width());
+
+    char safe[4];
+    char closer[4];
+    int safeCount = 0;
+    int closerCount = 0;
+    for (char dir : DIRECTIONS) {
+        if (is_reverse(engine.getDirection(), dir)) continue;
+        auto next = board.next(head, dir);
+        if (engine.isOccupied(next) || next == engine.getPoisonFood()) continue;
+        safe[safeCount++] = dir;
+        if ((dir == DIR_RIGHT && dc > 0) || (dir == DIR_LEFT && dc < 0) ||
+            (dir == DIR_DOWN && dr > 0) || (dir == DIR_UP && dr < 0)) {
+            closer[closerCount++] = dir;
+        }
+    }
+    if (closerCount > 0) return closer[rng.below(closerCount)];
+    if (safeCount > 0) return safe[rng.below(safeCount)];
+    return engine.getDirection();
+}
+
+// BfsAgent class implementation
+BfsAgent::BfsAgent(const DynamicBoard& board)
+    : cells(board.cells()), neighbors(static_cast<size_t>(board.cells()) * 4), queue(board.cells()),
+      visited(board.cells(), 0), firstDir(board.cells(), 0), dist(board.cells(), 0), generation(0),
+      poisonCell(-1) {
+    for (int cell = 0; cell < cells; cell++) {
+        for (int d = 0; d < 4; d++) {
+            neighbors[cell * 4 + d] = board.index(board.next(board.position(cell), DIRECTIONS[d]));
+        }
+    }
+}
+
+void BfsAgent::prepare(const SnakeEngine& engine) {
+    std::pair<int, int> poison = engine.getPoisonFood();
+    poisonCell = poison.first >= 0 ? engine.getBoard().index(poison) : -1;
+}
+
+bool BfsAgent::passable(const SnakeEngine& engine, int cell) const {
+    return !engine.isOccupied(cell) && cell != poisonCell;
+}
+
+bool BfsAgent::search(const SnakeEngine& engine, int start, int target, int* reached) {
+    if (++generation == 0) {
+        // Stamps wrapped around: clear them once every 2^32 searches
+        std::fill(visited.begin(), visited.end(), 0);
+        generation = 1;
+    }
+    int headPos = 0;
+    int tailPos = 0;
+    queue[tailPos++] = start;
+    visited[start] = generation;
+    dist[start] = 0;
+    bool found = false;
+    while (headPos < tailPos) {
+        int cell = queue[headPos++];
+        if (cell == target) {
+            found = true;
+            break;
+        }
+        for (int d = 0; d < 4; d++) {
+            int next = neighbors[cell * 4 + d];
+            if (visited[next] == generation || (next != target && !passable(engine, next))) continue;
+            visited[next] = generation;
+            firstDir[next] = cell == start ? static_cast<uint8_t>(d) : firstDir[cell];
+            dist[next] = dist[cell] + 1;
+            queue[tailPos++] = next;
+        }
+    }
+    if (reached) *reached = tailPos;
+    return found;
+}
+
+char BfsAgent::chooseMove(const SnakeEngine& engine) {
+    const DynamicBoard& board = engine.getBoard();
+    const SnakeBody& body = engine.getBody();
+    int head = body.back();
+    int tail = body.front();
+    std::pair<int, int> foodPos = engine.getFood();
+    prepare(engine);
+    if (foodPos.first >= 0 && search(engine, head, board.index(foodPos))) {
+        char dir = DIRECTIONS[firstDir[board.index(foodPos)]];
+        int next = neighbors[head * 4 + dir];
+        // Only commit to the path if the tail stays in reach from its first step
+        if (!is_reverse(engine.getDirection(), dir) && (body.size() < 3 || search(engine, next, tail))) {
+            return dir;
+        }
+    }
+    return stall(engine);
+}
+
+char BfsAgent::stall(const SnakeEngine& engine) {
+    const SnakeBody& body = engine.getBody();
+    int head = body.back();
+    int tail = body.front();
+    prepare(engine);
+
+    // Prefer moves that keep the tail reachable, and among those the one
+    // furthest from it; with none, the move that leaves the most room
+    char best = engine.getDirection();
+    int bestScore = -1;
+    for (char dir : DIRECTIONS) {
+        int next = neighbors[head * 4 + dir];
+        if (is_reverse(engine.getDirection(), dir) || !passable(engine, next)) continue;
+        int reached = 0;
+        int score = search(engine, next, tail, &reached) ? cells + dist[tail] : reached;
+        if (score > bestScore) {
+            bestScore = score;
+            best = dir;
+        }
+    }
+    return best;
+}
+
+// HamiltonianAgent class implementation
+HamiltonianAgent::HamiltonianAgent(const DynamicBoard& board) : cells(board.cells()), detour(board) {
+    const int w = board.width();
+    const int h = board.height();
+    if (h % 2 != 0 && w % 2 != 0) {
+        return;
+    }
+    cycleDir.resize(board.cells());
+    for (int row = 0; row < h; row++) {
+        for (int col = 0; col < w; col++) {
+            char dir;
+            if (h % 2 == 0) {
+                // Right along even rows, left along odd rows, down at the ends;
+                // the last row is odd, so its final step wraps back to (0, 0)
+                if (row % 2 == 0) {
+                    dir = col + 1 < w ? DIR_RIGHT : DIR_DOWN;
+                } else {
+                    dir = col > 0 ? DIR_LEFT : DIR_DOWN;
+                }
+            } else {
+                // The same pattern turned on its side
+                if (col % 2 == 0) {
+                    dir = row + 1 < h ? DIR_DOWN : DIR_RIGHT;
+                } else {
+                    dir = row > 0 ? DIR_UP : DIR_RIGHT;
+                }
+            }
+            cycleDir[board.index(std::make_pair(row, col))] = static_cast<uint8_t>(dir);
+        }
+    }
+    cycleIndex.resize(cells);
+    std::pair<int, int> pos(0, 0);
+    for (int i = 0; i < cells; i++) {
+        cycleIndex[board.index(pos)] = i;
+        pos = board.next(pos, static_cast<char>(cycleDir[board.index(pos)]));
+    }
+}
+
+char HamiltonianAgent::chooseMove(const SnakeEngine& engine) {
+    if (cycleDir.empty()) {
+        return detour.chooseMove(engine);
+    }
+    // Room kept free between a shortcut and the tail for the snake to grow into
+    const int SHORTCUT_SLACK = 4;
+    const DynamicBoard& board = engine.getBoard();
+    const SnakeBody& body = engine.getBody();
+    int head = body.back();
+    int toTail = body.size() > 1 ? cycleDistance(head, body.front()) : cells;
+    int toFood = engine.getFood().first >= 0 ? cycleDistance(head, board.index(engine.getFood())) : cells;
+    // Poison stays put until the food is eaten. If it sits between the head
+    // and the food, following the cycle would circle forever, so the snake
+    // has to find a shortcut that jumps over it whatever its length.
+    std::pair<int, int> poison = engine.getPoisonFood();
+    int toPoison = poison.first >= 0 ? cycleDistance(head, board.index(poison)) : cells;
+    bool poisonAhead = toPoison < toFood;
+    bool shortcuts = body.size() < cells / 2 || poisonAhead;
+
+    // Among moves that keep the body in cycle order, take the one that gets
+    // furthest without passing the food. Moves that still leave the poison
+    // in the way are a last resort, and then the plain cycle step keeps the
+    // most shortcuts open.
+    char best = -1;
+    int bestDistance = 0;
+    char plain = -1;
+    for (char dir : DIRECTIONS) {
+        std::pair<int, int> next = board.next(engine.getHead(), dir);
+        if (is_reverse(engine.getDirection(), dir) || engine.isOccupied(next) || next == poison) {
+            continue;
+        }
+        int d = cycleDistance(head, board.index(next));
+        bool ordered = d == 1 || (shortcuts && d < toTail - SHORTCUT_SLACK && d <= toFood);
+        if (!ordered) continue;
+        if (poisonAhead && d < toPoison) {
+            if (plain < 0 || d == 1) plain = dir;
+        } else if (d > bestDistance) {
+            bestDistance = d;
+            best = dir;
+        }
+    }
+    if (best >= 0) return best;
+    if (plain >= 0) return plain;
+    // Poison on the next cycle cell and no way round it: leave the cycle
+    return detour.stall(engine);
+}
+
+std::unique_ptr<Agent> make_agent(const std::string& name, const DynamicBoard& board) {
+    if (name == "greedy") {
+        return std::unique_ptr<Agent>(new GreedyAgent());
+    } else if (name == "bfs") {
+        return std::unique_ptr<Agent>(new BfsAgent(board));
+    } else if (name == "hamiltonian") {
+        return std::unique_ptr<Agent>(new HamiltonianAgent(board));
+    }
+    return nullptr;
+}
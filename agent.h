@@ -0,0 +1,80 @@
+#ifndef AGENT_H
+#define AGENT_H
+
+#include "engine.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Picks among the moves that do not die immediately, preferring one that
+// closes in on the food and breaking ties at random. Cheap and short-lived.
+class GreedyAgent : public Agent {
+private:
+    Xoshiro256 rng;
+
+public:
+    void reset(uint64_t seed) override { rng.reseed(splitmix64(seed)); }
+    char chooseMove(const SnakeEngine& engine) override;
+};
+
+// Shortest path to the food, taken only if the snake can still reach its own
+// tail from the first step; otherwise it stalls by following the tail the
+// long way round. Every search runs over buffers sized once for the board,
+// so choosing a move never allocates.
+class BfsAgent : public Agent {
+private:
+    int cells;
+    std::vector<int> neighbors;     // 4 per cell, in DIRECTIONS order
+    std::vector<int> queue;         // frontier, one slot per cell
+    std::vector<uint32_t> visited;  // cell -> search generation that reached it
+    std::vector<uint8_t> firstDir;  // cell -> first move of the path that reached it
+    std::vector<int> dist;          // cell -> steps from the search start
+    uint32_t generation;
+    int poisonCell;                 // poison of the position being searched, -1 when none
+
+    void prepare(const SnakeEngine& engine);
+    bool passable(const SnakeEngine& engine, int cell) const;
+    // Breadth-first search from start; returns true if target was reached.
+    // Cells reached are stamped with the current generation.
+    bool search(const SnakeEngine& engine, int start, int target, int* reached = nullptr);
+
+public:
+    explicit BfsAgent(const DynamicBoard& board);
+    char chooseMove(const SnakeEngine& engine) override;
+    // Safest move when there is no usable path to the food
+    char stall(const SnakeEngine& engine);
+};
+
+// Follows a fixed Hamiltonian cycle through every cell, a serpentine over
+// rows (even height) or columns (even width). The body always lies along the
+// cycle between tail and head, so the snake can fill the board without ever
+// trapping itself. While it covers less than half the board it may skip ahead
+// along the cycle towards the food, as long as it lands short of its tail,
+// and at any length it may do so to get round poison. Odd by odd boards have no serpentine cycle and are
+// played by the BFS agent alone.
+class HamiltonianAgent : public Agent {
+private:
+    int cells;
+    std::vector<uint8_t> cycleDir; // cell -> direction to the next cell on the cycle, empty if none
+    std::vector<int> cycleIndex;   // cell -> position along the cycle
+    BfsAgent detour;
+
+    // Steps from cell a forward along the cycle to cell b
+    int cycleDistance(int a, int b) const {
+        int d = cycleIndex[b] - cycleIndex[a];
+        return d < 0 ? d + cells : d;
+    }
+
+public:
+    explicit HamiltonianAgent(const DynamicBoard& board);
+    char chooseMove(const SnakeEngine& engine) override;
+    bool hasCycle() const { return !cycleDir.empty(); }
+};
+
+// Names accepted by make_agent, for usage messages
+const char* const AGENT_NAMES = "greedy, bfs, hamiltonian";
+
+// Agent called name for games on board, or nullptr if there is no such agent
+std::unique_ptr<Agent> make_agent(const std::string& name, const DynamicBoard& board);
+
+#endif
@@ -0,0 +1,307 @@
+#include "arena.h"
+
+// Arena class implementation
+Arena::Arena(const ArenaConfig& config, ThreadPool* pool)
+    : config(config), board(config.width, config.height), cells(config.width * config.height),
+      regionCount(config.regions > 0 ? std::min(config.regions, config.height) : std::max(1, config.height / 16)),
+      pool(pool), owner(cells), foodAt(cells), claims(new std::atomic<uint32_t>[cells]), stamp(0),
+      bodies(config.snakes), direction(config.snakes), alive(config.snakes), nextCell(config.snakes),
+      hitBody(config.snakes), events(config.snakes), scores(config.snakes), homeRegion(config.snakes),
+      regions(new Region[regionCount]), order(config.snakes), regionStart(regionCount + 1), regionFill(regionCount),
+      ticks(0), recording(false) {
+    int capacity = std::max(1, std::min(config.maxLength, cells));
+    for (SnakeBody& body : bodies) {
+        body.reset(capacity);
+    }
+    reset();
+}
+
+void Arena::reset() {
+    std::fill(owner.begin(), owner.end(), -1);
+    std::fill(foodAt.begin(), foodAt.end(), 0);
+    for (int i = 0; i < cells; i++) {
+        claims[i].store(0, std::memory_order_relaxed);
+    }
+    stamp = 0;
+    ticks = 0;
+    std::fill(regionStart.begin(), regionStart.end(), 0); // no respawns from the previous game
+
+    uint64_t state = config.seed;
+    for (int r = 0; r < regionCount; r++) {
+        Region& region = regions[r];
+        region.rng.reseed(splitmix64(state));
+        region.food.store(0, std::memory_order_relaxed);
+        // Rows whose regionOfRow is r; food is shared out in proportion to them
+        region.rowBegin = static_cast<int>((static_cast<int64_t>(r) * board.height() + regionCount - 1) / regionCount);
+        region.rowEnd = static_cast<int>((static_cast<int64_t>(r + 1) * board.height() + regionCount - 1) / regionCount);
+        region.foodTarget = static_cast<int>(static_cast<int64_t>(config.food) * region.rowEnd / board.height() -
+                                             static_cast<int64_t>(config.food) * region.rowBegin / board.height());
+        region.eaten = 0;
+        region.headOn = 0;
+        region.hitBody = 0;
+        region.respawns = 0;
+        region.moved.clear();
+        region.refilled.clear();
+    }
+    for (int k = 0; k < config.snakes; k++) {
+        bodies[k].clear();
+        alive[k] = 0;
+        scores[k] = 0;
+        homeRegion[k] = k % regionCount;
+        spawnSnake(k, homeRegion[k]);
+        events[k] = static_cast<uint8_t>(alive[k] ? ArenaEvent::Moved : ArenaEvent::Dead);
+    }
+    for (int r = 0; r < regionCount; r++) {
+        refill(r);
+        regions[r].refilled.clear();
+    }
+}
+
+bool Arena::randomEmptyCell(int r, int& cell) {
+    Region& region = regions[r];
+    int rows = region.rowEnd - region.rowBegin;
+    if (rows <= 0) return false;
+    // Rejection sampling: arenas are mostly empty, and a crowded band simply
+    // tries again next tick
+    for (int attempt = 0; attempt < 64; attempt++) {
+        int candidate = (region.rowBegin + region.rng.below(rows)) * board.width() + region.rng.below(board.width());
+        if (owner[candidate] < 0 && !foodAt[candidate]) {
+            cell = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Arena::spawnSnake(int k, int r) {
+    int cell;
+    if (!randomEmptyCell(r, cell)) return;
+    bodies[k].clear();
+    bodies[k].pushBack(cell);
+    owner[cell] = k;
+    note(recording, regions[r].refilled, cell, k);
+    direction[k] = static_cast<uint8_t>(regions[r].rng.below(4));
+    alive[k] = 1;
+}
+
+void Arena::bucketSnakes() {
+    // Counting sort by band, keeping snake ids ascending within each band
+    std::fill(regionStart.begin(), regionStart.end(), 0);
+    for (int k = 0; k < config.snakes; k++) {
+        if (alive[k]) {
+            homeRegion[k] = regionOfCell(bodies[k].back());
+        }
+        regionStart[homeRegion[k] + 1]++;
+    }
+    for (int r = 0; r < regionCount; r++) {
+        regionStart[r + 1] += regionStart[r];
+    }
+    std::copy(regionStart.begin(), regionStart.end() - 1, regionFill.begin());
+    for (int k = 0; k < config.snakes; k++) {
+        order[regionFill[homeRegion[k]]++] = k;
+    }
+}
+
+void Arena::forEachRegion(void (Arena::*pass)(int)) {
+    if (pool && pool->size() > 1 && regionCount > 1) {
+        pool->parallelFor(regionCount, 1, [this, pass](int64_t begin, int64_t end, unsigned) {
+            for (int64_t r = begin; r < end; r++) {
+                (this->*pass)(static_cast<int>(r));
+            }
+        });
+    } else {
+        for (int r = 0; r < regionCount; r++) {
+            (this->*pass)(r);
+        }
+    }
+}
+
+void Arena::claimMoves(int r) {
+    const uint32_t mine = stamp << 1;
+    for (int i = regionStart[r]; i < regionStart[r + 1]; i++) {
+        int k = order[i];
+        if (!alive[k]) continue;
+        int next = board.index(board.next(board.position(bodies[k].back()), static_cast<char>(direction[k])));
+        nextCell[k] = next;
+        // The grid is only read in this pass, so this is the state at the start of the tick
+        hitBody[k] = owner[next] >= 0;
+
+        // First claimant stamps the cell; anyone arriving later marks it contested
+        std::atomic<uint32_t>& claim = claims[next];
+        uint32_t seen = claim.load(std::memory_order_relaxed);
+        while (true) {
+            if ((seen >> 1) == stamp) {
+                claim.fetch_or(1, std::memory_order_relaxed);
+                break;
+            }
+            if (claim.compare_exchange_weak(seen, mine, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+    }
+}
+
+void Arena::applyMoves(int r) {
+    Region& region = regions[r];
+    region.moved.clear();
+    region.refilled.clear();
+    for (int i = regionStart[r]; i < regionStart[r + 1]; i++) {
+        int k = order[i];
+        if (!alive[k]) {
+            events[k] = static_cast<uint8_t>(ArenaEvent::Dead);
+            continue;
+        }
+        int next = nextCell[k];
+        bool contested = (claims[next].load(std::memory_order_relaxed) & 1) != 0;
+        SnakeBody& body = bodies[k];
+        if (contested || hitBody[k]) {
+            // Every cell of a dead body was occupied at the start of the tick,
+            // so no surviving snake is moving into one of them
+            for (int s = 0; s < body.size(); s++) {
+                owner[body[s]] = -1;
+                note(recording, region.moved, body[s], ARENA_EMPTY);
+            }
+            body.clear();
+            alive[k] = 0;
+            if (contested) {
+                region.headOn++;
+                events[k] = static_cast<uint8_t>(ArenaEvent::HeadOn);
+            } else {
+                region.hitBody++;
+                events[k] = static_cast<uint8_t>(ArenaEvent::HitBody);
+            }
+            continue;
+        }
+
+        // next was empty and claimed by this snake alone, so it is ours to write
+        bool ate = foodAt[next] != 0;
+        if (ate) {
+            foodAt[next] = 0;
+            regions[regionOfCell(next)].food.fetch_sub(1, std::memory_order_relaxed);
+            region.eaten++;
+            scores[k] += 10;
+        }
+        if (!ate || body.size() == body.capacity()) {
+            owner[body.front()] = -1;
+            note(recording, region.moved, body.front(), ARENA_EMPTY);
+            body.popFront();
+        }
+        body.pushBack(next);
+        owner[next] = k;
+        note(recording, region.moved, next, k);
+        events[k] = static_cast<uint8_t>(ate ? ArenaEvent::Ate : ArenaEvent::Moved);
+    }
+}
+
+void Arena::refill(int r) {
+    Region& region = regions[r];
+    if (config.respawn) {
+        for (int i = regionStart[r]; i < regionStart[r + 1]; i++) {
+            int k = order[i];
+            if (alive[k] || events[k] != static_cast<uint8_t>(ArenaEvent::Dead)) continue;
+            spawnSnake(k, r);
+            if (alive[k]) {
+                region.respawns++;
+                events[k] = static_cast<uint8_t>(ArenaEvent::Respawned);
+            }
+        }
+    }
+    int cell;
+    while (region.food.load(std::memory_order_relaxed) < region.foodTarget && randomEmptyCell(r, cell)) {
+        foodAt[cell] = 1;
+        region.food.fetch_add(1, std::memory_order_relaxed);
+        note(recording, region.refilled, cell, ARENA_FOOD);
+    }
+}
+
+void Arena::step(const uint8_t* actions) {
+    for (int k = 0; k < config.snakes; k++) {
+        uint8_t action = actions[k] & 3;
+        if (alive[k] && (action ^ direction[k]) != 1) {
+            direction[k] = action;
+        }
+    }
+    if (++stamp == (1u << 31)) {
+        // Stamps wrapped: forget every old claim once every 2^31 ticks
+        for (int i = 0; i < cells; i++) {
+            claims[i].store(0, std::memory_order_relaxed);
+        }
+        stamp = 1;
+    }
+
+    bucketSnakes();
+    forEachRegion(&Arena::claimMoves);
+    forEachRegion(&Arena::applyMoves);
+    forEachRegion(&Arena::refill);
+    ticks++;
+}
+
+bool Arena::placeSnake(int k, const std::vector<std::pair<int, int>>& segments, char dir) {
+    if (segments.empty() || static_cast<int>(segments.size()) > bodies[k].capacity()) {
+        return false;
+    }
+    for (size_t i = 0; i < segments.size(); i++) {
+        const auto& pos = segments[i];
+        if (pos.first < 0 || pos.first >= board.height() || pos.second < 0 || pos.second >= board.width()) {
+            return false;
+        }
+        int cell = board.index(pos);
+        if ((owner[cell] >= 0 && owner[cell] != k) ||
+            std::find(segments.begin(), segments.begin() + i, pos) != segments.begin() + i) {
+            return false;
+        }
+    }
+    SnakeBody& body = bodies[k];
+    for (int s = 0; s < body.size(); s++) {
+        owner[body[s]] = -1;
+    }
+    body.clear();
+    for (const auto& pos : segments) {
+        int cell = board.index(pos);
+        body.pushBack(cell);
+        owner[cell] = k;
+        if (foodAt[cell]) {
+            foodAt[cell] = 0;
+            regions[regionOfCell(cell)].food.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    direction[k] = static_cast<uint8_t>(dir);
+    alive[k] = 1;
+    homeRegion[k] = regionOfCell(body.back());
+    return true;
+}
+
+ArenaStats Arena::stats() const {
+    ArenaStats total;
+    total.ticks = ticks;
+    for (int r = 0; r < regionCount; r++) {
+        total.eaten += regions[r].eaten;
+        total.headOn += regions[r].headOn;
+        total.hitBody += regions[r].hitBody;
+        total.respawns += regions[r].respawns;
+        total.food += regions[r].food.load(std::memory_order_relaxed);
+    }
+    for (int k = 0; k < config.snakes; k++) {
+        total.alive += alive[k];
+    }
+    return total;
+}
+
+uint8_t arena_bot_move(const Arena& arena, int k, Xoshiro256& rng) {
+    const DynamicBoard& board = arena.getBoard();
+    std::pair<int, int> head = board.position(arena.head(k));
+    char current = arena.getDirection(k);
+    char free[4];
+    int freeCount = 0;
+    for (char dir : DIRECTIONS) {
+        if (is_reverse(current, dir)) continue;
+        int next = board.index(board.next(head, dir));
+        if (arena.ownerAt(next) >= 0) continue;
+        if (arena.hasFood(next)) return static_cast<uint8_t>(dir);
+        free[freeCount++] = dir;
+    }
+    for (int i = 0; i < freeCount; i++) {
+        if (free[i] == current && rng.below(8) != 0) return static_cast<uint8_t>(current);
+    }
+    return static_cast<uint8_t>(freeCount > 0 ? free[rng.below(freeCount)] : current);
+}
@@ -0,0 +1,185 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "engine.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Options for a multi-snake arena
+struct ArenaConfig {
+    int width = 256;
+    int height = 256;
+    int snakes = 256;
+    int food = 512;        // food items kept on the board
+    int regions = 0;       // horizontal bands the board is split into; 0 picks one per 16 rows
+    int maxLength = 1024;  // snakes stop growing here but still score
+    bool respawn = true;   // dead snakes come back at length 1 from the tick after they die
+    uint64_t seed = 1;
+};
+
+// What happened to one snake on the last tick
+enum class ArenaEvent : uint8_t {
+    Moved,
+    Ate,
+    HeadOn,    // two or more heads entered the same cell; all of them died
+    HitBody,   // ran into a segment of any snake, itself included
+    Respawned,
+    Dead       // waiting for a free cell to respawn in, or respawn is off
+};
+
+// Cell values in the change log besides snake ids
+const int32_t ARENA_EMPTY = -1;
+const int32_t ARENA_FOOD = -2;
+
+// One cell's new contents: a snake id, ARENA_EMPTY or ARENA_FOOD
+struct ArenaChange {
+    int32_t cell;
+    int32_t value;
+};
+
+// Totals since the last reset
+struct ArenaStats {
+    int64_t ticks = 0;
+    int64_t eaten = 0;
+    int64_t headOn = 0;
+    int64_t hitBody = 0;
+    int64_t respawns = 0;
+    int alive = 0;
+    int food = 0;
+};
+
+// Many snakes and many food items on one wrapping board. Every cell of a
+// shared grid records which snake covers it, so collision checks are a single
+// lookup however many snakes there are.
+//
+// The board is split into horizontal bands and each tick runs in three
+// passes over the bands, in parallel when given a thread pool:
+//   1. every live snake picks its next cell, claims it in an atomic claim
+//      grid and notes whether a body is already there;
+//   2. snakes whose cell was claimed twice or was occupied die and are
+//      cleared from the grid, the rest move or eat;
+//   3. each band tops up its own food and respawns its own dead snakes.
+// Writes in passes 1 and 2 go to cells no other snake can touch that tick,
+// and pass 3 only writes inside its band with that band's own random
+// stream, so results are the same for any number of threads.
+class Arena {
+private:
+    // Per-band state, padded so bands on different threads never share a line
+    struct alignas(64) Region {
+        Xoshiro256 rng;
+        std::atomic<int> food;
+        int foodTarget;
+        int rowBegin;
+        int rowEnd;
+        int64_t eaten;
+        int64_t headOn;
+        int64_t hitBody;
+        int64_t respawns;
+        // Cells changed this tick, when recording: by moves first, then refills
+        std::vector<ArenaChange> moved;
+        std::vector<ArenaChange> refilled;
+    };
+
+    ArenaConfig config;
+    DynamicBoard board;
+    int cells;
+    int regionCount;
+    ThreadPool* pool;
+
+    // Shared grids, one entry per cell
+    std::vector<int32_t> owner;     // snake covering the cell, -1 when empty
+    std::vector<uint8_t> foodAt;
+    std::unique_ptr<std::atomic<uint32_t>[]> claims; // tick stamp << 1 | contested
+    uint32_t stamp;
+
+    // One entry per snake
+    std::vector<SnakeBody> bodies;
+    std::vector<uint8_t> direction;
+    std::vector<uint8_t> alive;
+    std::vector<int32_t> nextCell;
+    std::vector<uint8_t> hitBody;
+    std::vector<uint8_t> events;
+    std::vector<int64_t> scores;
+    std::vector<int32_t> homeRegion; // band the snake was last in
+
+    std::unique_ptr<Region[]> regions;
+    std::vector<int32_t> order;       // snakes grouped by band
+    std::vector<int32_t> regionStart; // order[regionStart[r] .. regionStart[r + 1]) are in band r
+    std::vector<int32_t> regionFill;  // scratch for bucketSnakes
+    int64_t ticks;
+    bool recording;
+
+    static void note(bool on, std::vector<ArenaChange>& log, int cell, int32_t value) {
+        if (on) log.push_back(ArenaChange{cell, value});
+    }
+    int regionOfRow(int row) const { return static_cast<int>(static_cast<int64_t>(row) * regionCount / board.height()); }
+    int regionOfCell(int cell) const { return regionOfRow(cell / board.width()); }
+    void bucketSnakes();
+    void forEachRegion(void (Arena::*pass)(int));
+    bool randomEmptyCell(int region, int& cell);
+    void spawnSnake(int k, int region);
+    void claimMoves(int region);
+    void applyMoves(int region);
+    void refill(int region);
+
+public:
+    explicit Arena(const ArenaConfig& config = ArenaConfig(), ThreadPool* pool = nullptr);
+
+    // Clear the board and place every snake and food item again
+    void reset();
+    // Advance one tick; actions[k] (0 right, 1 left, 2 up, 3 down) steers
+    // snake k and reversals are ignored. Dead snakes ignore their action.
+    void step(const uint8_t* actions);
+    // Replace snake k with body (tail first, adjacent segments) heading in
+    // dir. Returns false and changes nothing if a segment is off the board,
+    // repeated, longer than the snake can grow or on another snake.
+    bool placeSnake(int k, const std::vector<std::pair<int, int>>& body, char dir);
+    // Keep a log of the cells each tick changes, for sending deltas to
+    // clients. reset() and placeSnake() are not logged.
+    void recordChanges(bool on) { recording = on; }
+    // Call fn(change) for every cell the last tick changed, in an order
+    // that leaves the final contents when applied one after another
+    template <typename Fn>
+    void forEachChange(Fn fn) const;
+
+    int size() const { return config.snakes; }
+    int regionCountUsed() const { return regionCount; }
+    const DynamicBoard& getBoard() const { return board; }
+    int64_t tickCount() const { return ticks; }
+    ArenaStats stats() const;
+
+    bool isAlive(int k) const { return alive[k] != 0; }
+    char getDirection(int k) const { return static_cast<char>(direction[k]); }
+    const SnakeBody& body(int k) const { return bodies[k]; }
+    int head(int k) const { return bodies[k].back(); }
+    int64_t score(int k) const { return scores[k]; }
+    ArenaEvent lastEvent(int k) const { return static_cast<ArenaEvent>(events[k]); }
+
+    // Snake covering cell, or -1
+    int ownerAt(int cell) const { return owner[cell]; }
+    bool hasFood(int cell) const { return foodAt[cell] != 0; }
+};
+
+// Simple bot for arena snakes: eat adjacent food, otherwise mostly keep
+// going straight while that is safe, otherwise turn into any free cell.
+// Only reads the arena, so many snakes can decide at once.
+uint8_t arena_bot_move(const Arena& arena, int k, Xoshiro256& rng);
+
+
+// Arena class implementation
+template <typename Fn>
+void Arena::forEachChange(Fn fn) const {
+    // Refills may reuse a cell a move emptied in another band, so every
+    // band's moves come before any band's refills
+    for (int r = 0; r < regionCount; r++) {
+        for (const ArenaChange& change : regions[r].moved) fn(change);
+    }
+    for (int r = 0; r < regionCount; r++) {
+        for (const ArenaChange& change : regions[r].refilled) fn(change);
+    }
+}
+
+#endif
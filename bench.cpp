@@ -0,0 +1,260 @@
+#include <benchmark/benchmark.h>
+#include "engine.h"
+#include "renderer.h"
+#include "agent.h"
+#include "observation.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Count every heap allocation so each benchmark can report allocations per
+// iteration next to its timing; a steady-state tick should report zero.
+static std::atomic<int64_t> g_allocations(0);
+
+// The replacements stay out of line: inlined into a caller, a delete would
+// show up as free() on memory from operator new and trip -Wmismatched-new-delete
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+static void* counted_alloc(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void* operator new(size_t size) {
+    return counted_alloc(size);
+}
+
+BENCH_NOINLINE void* operator new[](size_t size) {
+    return counted_alloc(size);
+}
+
+BENCH_NOINLINE void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+BENCH_NOINLINE void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+BENCH_NOINLINE void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+BENCH_NOINLINE void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// Allocations made while a benchmark loop ran, reported per iteration
+class AllocationCounter {
+private:
+    benchmark::State& state;
+    int64_t start;
+    int64_t excluded;
+
+public:
+    explicit AllocationCounter(benchmark::State& state)
+        : state(state), start(g_allocations.load(std::memory_order_relaxed)), excluded(0) {}
+    ~AllocationCounter() {
+        state.counters["allocs/op"] = benchmark::Counter(
+            static_cast<double>(g_allocations.load(std::memory_order_relaxed) - start - excluded),
+            benchmark::Counter::kAvgIterations);
+    }
+
+    // Leave out allocations made by untimed setup inside the loop
+    template <typename Fn>
+    void exclude(Fn fn) {
+        int64_t before = g_allocations.load(std::memory_order_relaxed);
+        fn();
+        excluded += g_allocations.load(std::memory_order_relaxed) - before;
+    }
+};
+
+// Direction that walks a boustrophedon cycle through every cell: right along
+// even rows, left along odd rows, down at the row ends. With an even number of
+// rows the last step wraps back to (0, 0), so a snake laid along the cycle can
+// follow it forever without hitting itself.
+static char serpentine_direction(const DynamicBoard& board, const std::pair<int, int>& pos) {
+    if (pos.first % 2 == 0) {
+        return pos.second + 1 < board.width() ? DIR_RIGHT : DIR_DOWN;
+    }
+    return pos.second > 0 ? DIR_LEFT : DIR_DOWN;
+}
+
+// Body of the given length laid along the serpentine cycle, tail first
+static std::vector<std::pair<int, int>> serpentine_body(const DynamicBoard& board, int length) {
+    std::vector<std::pair<int, int>> body;
+    std::pair<int, int> pos(0, 0);
+    for (int i = 0; i < length; i++) {
+        body.push_back(pos);
+        pos = board.next(pos, serpentine_direction(board, pos));
+    }
+    return body;
+}
+
+// Engine whose snake covers fillPercent of a size x size board
+static SnakeEngine make_engine(int size, int fillPercent) {
+    DynamicBoard board(size, size);
+    SnakeEngine engine(board, 1);
+    int length = std::max(1, static_cast<int>(static_cast<int64_t>(board.cells()) * fillPercent / 100));
+    length = std::min(length, board.cells() - 2); // leave room for food
+    engine.placeSnake(serpentine_body(board, length), DIR_RIGHT);
+    return engine;
+}
+
+static void BoardSizes(benchmark::internal::Benchmark* b) {
+    for (int size : {10, 64, 1024, 4096}) {
+        b->Args({size});
+    }
+}
+
+static void BoardSizesAndFill(benchmark::internal::Benchmark* b) {
+    for (int size : {10, 64, 256}) {
+        for (int fill : {10, 50, 90, 99}) {
+            b->Args({size, fill});
+        }
+    }
+}
+
+static void BM_GetNextHead(benchmark::State& state) {
+    DynamicBoard board(static_cast<int>(state.range(0)), static_cast<int>(state.range(0)));
+    std::pair<int, int> pos(0, 0);
+    int i = 0;
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        pos = board.next(pos, DIRECTIONS[(i++ >> 3) & 3]);
+        benchmark::DoNotOptimize(pos);
+    }
+}
+BENCHMARK(BM_GetNextHead)->Apply(BoardSizes);
+
+template <int N>
+static void BM_GetNextHeadFixed(benchmark::State& state) {
+    FixedBoard<N, N> board;
+    std::pair<int, int> pos(0, 0);
+    int i = 0;
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        pos = board.next(pos, DIRECTIONS[(i++ >> 3) & 3]);
+        benchmark::DoNotOptimize(pos);
+    }
+}
+BENCHMARK_TEMPLATE(BM_GetNextHeadFixed, 10);
+BENCHMARK_TEMPLATE(BM_GetNextHeadFixed, 64);
+BENCHMARK_TEMPLATE(BM_GetNextHeadFixed, 4096);
+
+static void BM_CollisionCheck(benchmark::State& state) {
+    SnakeEngine engine = make_engine(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const DynamicBoard& board = engine.getBoard();
+    Xoshiro256 rng(7);
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        std::pair<int, int> pos(rng.below(board.height()), rng.below(board.width()));
+        benchmark::DoNotOptimize(engine.isOccupied(pos));
+    }
+}
+BENCHMARK(BM_CollisionCheck)->Apply(BoardSizesAndFill);
+
+static void BM_GenerateFood(benchmark::State& state) {
+    SnakeEngine engine = make_engine(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        engine.respawnFood();
+        benchmark::DoNotOptimize(engine.getFood());
+    }
+}
+BENCHMARK(BM_GenerateFood)->Apply(BoardSizesAndFill);
+
+// Full redraw of every cell into the renderer's buffer; nothing is written out
+static void BM_RenderFullFrame(benchmark::State& state) {
+    SnakeEngine engine = make_engine(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    TerminalRenderer renderer;
+    const std::vector<std::string> status = {"length of snake: 0", "Score: 0 points"};
+    renderer.render(engine, status);
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        renderer.invalidate();
+        benchmark::DoNotOptimize(renderer.render(engine, status).data());
+    }
+}
+BENCHMARK(BM_RenderFullFrame)->Args({10, 50})->Args({64, 50})->Args({256, 50});
+
+// One engine step followed by a diff frame, i.e. a complete interactive tick
+// minus the write and the sleep
+static void BM_Tick(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    const int fill = static_cast<int>(state.range(1));
+    SnakeEngine engine = make_engine(size, fill);
+    TerminalRenderer renderer;
+    const std::vector<std::string> status = {"length of snake: 0", "Score: 0 points"};
+    const bool render = size <= 64;
+    if (render) renderer.render(engine, status);
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        TickResult result = engine.step(serpentine_direction(engine.getBoard(), engine.getHead()));
+        if (result != TickResult::Moved && result != TickResult::Ate) {
+            state.PauseTiming();
+            allocations.exclude([&] { engine = make_engine(size, fill); });
+            state.ResumeTiming();
+        }
+        if (render) {
+            benchmark::DoNotOptimize(renderer.render(engine, status).data());
+        }
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_Tick)->Apply(BoardSizesAndFill);
+
+// One BFS autopilot decision, which searches the whole free area when the
+// snake is long; should report zero allocations
+static void BM_BfsAgentMove(benchmark::State& state) {
+    SnakeEngine engine = make_engine(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    BfsAgent agent(engine.getBoard());
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(agent.chooseMove(engine));
+    }
+}
+BENCHMARK(BM_BfsAgentMove)->Args({10, 50})->Args({64, 50})->Args({256, 50});
+
+// Checkpoint and rewind a game, as a tree search does at every node
+static void BM_SnapshotRestore(benchmark::State& state) {
+    SnakeEngine engine = make_engine(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    std::vector<uint64_t> blob((engine.snapshotSize() + 7) / 8);
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        engine.snapshot(blob.data());
+        benchmark::DoNotOptimize(engine.restore(blob.data(), engine.snapshotSize()));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * engine.snapshotSize());
+}
+BENCHMARK(BM_SnapshotRestore)->Args({10, 50})->Args({64, 50})->Args({256, 50});
+
+// Planes, body ages and 11x11 crops for a whole batch, as a trainer
+// encodes them after every step
+static void BM_EncodeObservations(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    SnakeBatch batch(256, size, size, 1);
+    std::vector<uint8_t> actions(batch.size(), ACTION_RIGHT);
+    for (int tick = 0; tick < 20; tick++) {
+        batch.step(actions.data());
+    }
+    std::vector<float> planes(planes_size(batch));
+    std::vector<float> ages(body_age_size(batch));
+    std::vector<float> crops(crop_size(batch, 5));
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        encode_planes(batch, planes.data());
+        encode_body_age(batch, ages.data());
+        encode_crops(batch, 5, crops.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * batch.size());
+}
+BENCHMARK(BM_EncodeObservations)->Arg(10)->Arg(32);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,8 @@
+#ifndef BOARD_LIMITS_H
+#define BOARD_LIMITS_H
+
+// Largest board side taken from the command line or a file. Boards size
+// their cell arrays from width * height as an int, which this keeps in range.
+const int MAX_BOARD_SIDE = 4096;
+
+#endif
@@ -0,0 +1,20 @@
+#include "engine.h"
+
+template class BasicSnakeEngine<DynamicBoard>;
+
+// Utility functions (keeping original interface for compatibility)
+std::pair<int, int> get_next_head(const std::pair<int, int>& current, char direction,
+                                  int width, int height) {
+    return DynamicBoard(width, height).next(current, direction);
+}
+
+const char* tick_result_name(TickResult result) {
+    switch (result) {
+        case TickResult::Moved: return "moved";
+        case TickResult::Ate: return "ate";
+        case TickResult::Poisoned: return "poisoned";
+        case TickResult::HitSelf: return "hit self";
+        case TickResult::Won: return "won";
+    }
+    return "unknown";
+}
@@ -0,0 +1,613 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "board_limits.h"
+#include "snapshot.h"
+#include "profile.h"
+
+// Simulation core shared by every front end: board geometry, the snake body,
+// the engine and the autopilot interface. Nothing here touches the terminal,
+// so headless tools (simulator, benchmarks, server) include only this.
+const int BOARD_SIZE = 10;
+const int POISON_CHANCE = 3; // 1 in 3 chance for poison food
+
+// Directions are small integers numbered in the order used by replays and
+// batched actions. Opposite directions differ only in the low bit.
+const char DIR_RIGHT = 0;
+const char DIR_LEFT = 1;
+const char DIR_UP = 2;
+const char DIR_DOWN = 3;
+
+const char DIRECTIONS[4] = {DIR_RIGHT, DIR_LEFT, DIR_UP, DIR_DOWN};
+
+// Outcome of a single simulation tick
+enum class TickResult {
+    Moved,     // head advanced, length unchanged
+    Ate,       // head landed on food, snake grew by one
+    Poisoned,  // head landed on poison food, game over
+    HitSelf,   // head ran into the body, game over
+    Won        // snake covers every cell, nowhere left to place food
+};
+
+// SplitMix64 step: expands a single seed into well-mixed 64-bit values
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** generator. Small, fast and fully determined by its seed, so
+// every game owns one and the same seed always yields the same stream.
+class Xoshiro256 {
+private:
+    uint64_t s[4];
+    
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    
+public:
+    explicit Xoshiro256(uint64_t seed = 0) { reseed(seed); }
+    
+    void reseed(uint64_t seed) {
+        for (uint64_t& word : s) {
+            word = splitmix64(seed);
+        }
+    }
+    
+    uint64_t operator()() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+    
+    // Value in [0, n) by multiply-shift; avoids the division in % and is
+    // identical on every platform, unlike std::uniform_int_distribution
+    int below(int n) { return static_cast<int>(((*this)() >> 32) * static_cast<uint64_t>(n) >> 32); }
+    
+    // Raw generator state, for snapshots
+    void getState(uint64_t out[4]) const { std::copy(s, s + 4, out); }
+    void setState(const uint64_t in[4]) { std::copy(in, in + 4, s); }
+};
+
+// Seed for games that did not ask for a specific one
+inline uint64_t random_seed() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^ device();
+}
+
+// Board geometry chosen at runtime (e.g. 1000x1000 arenas). Positions are
+// (row, column) pairs and moving off an edge wraps to the opposite side.
+class DynamicBoard {
+private:
+    int w;
+    int h;
+    
+public:
+    DynamicBoard(int width = BOARD_SIZE, int height = BOARD_SIZE) : w(width), h(height) {}
+    
+    int width() const { return w; }
+    int height() const { return h; }
+    int cells() const { return w * h; }
+    int index(const std::pair<int, int>& pos) const { return pos.first * w + pos.second; }
+    std::pair<int, int> position(int idx) const { return std::make_pair(idx / w, idx % w); }
+    std::pair<int, int> next(const std::pair<int, int>& current, char dir) const;
+};
+
+// Board geometry fixed at compile time. Every size constant folds away and,
+// for power-of-two dimensions, wraparound is a single mask instead of a
+// compare or modulo.
+template <int W, int H>
+class FixedBoard {
+    static_assert(W > 0 && H > 0, "board dimensions must be positive");
+    
+public:
+    static constexpr bool POWER_OF_TWO = (W & (W - 1)) == 0 && (H & (H - 1)) == 0;
+    
+    constexpr int width() const { return W; }
+    constexpr int height() const { return H; }
+    constexpr int cells() const { return W * H; }
+    constexpr int index(const std::pair<int, int>& pos) const { return pos.first * W + pos.second; }
+    std::pair<int, int> position(int idx) const { return std::make_pair(idx / W, idx % W); }
+    std::pair<int, int> next(const std::pair<int, int>& current, char dir) const;
+};
+
+// Fixed-capacity ring buffer of packed cell indices holding the snake body,
+// tail first. Sized once to the board's cell count, so moving never allocates.
+class SnakeBody {
+private:
+    std::vector<int32_t> ring;
+    int32_t start;
+    int32_t count;
+    
+public:
+    SnakeBody() : start(0), count(0) {}
+    
+    void reset(int capacity) {
+        ring.assign(capacity, 0);
+        start = 0;
+        count = 0;
+    }
+    // Drop every segment but keep the storage
+    void clear() {
+        start = 0;
+        count = 0;
+    }
+    void pushBack(int cell) {
+        int pos = start + count;
+        ring[pos >= static_cast<int>(ring.size()) ? pos - static_cast<int>(ring.size()) : pos] = cell;
+        count++;
+    }
+    void popFront() {
+        start = start + 1 == static_cast<int>(ring.size()) ? 0 : start + 1;
+        count--;
+    }
+    // i-th segment counting from the tail
+    int operator[](int i) const {
+        int pos = start + i;
+        return ring[pos >= static_cast<int>(ring.size()) ? pos - static_cast<int>(ring.size()) : pos];
+    }
+    // Copy the segments, tail first, to out
+    void copyTo(int32_t* out) const {
+        int firstRun = std::min(count, static_cast<int>(ring.size()) - start);
+        std::memcpy(out, ring.data() + start, sizeof(int32_t) * firstRun);
+        std::memcpy(out + firstRun, ring.data(), sizeof(int32_t) * (count - firstRun));
+    }
+    // Replace the segments with n cells from in, tail first; n must fit
+    void assign(const int32_t* in, int n) {
+        std::memcpy(ring.data(), in, sizeof(int32_t) * n);
+        start = 0;
+        count = n;
+    }
+    int front() const { return ring[start]; }
+    int back() const { return (*this)[count - 1]; }
+    int size() const { return count; }
+    int capacity() const { return static_cast<int>(ring.size()); }
+    bool empty() const { return count == 0; }
+};
+
+// Lightweight read-only view over a SnakeBody that yields (row, column)
+// pairs, tail first. Copying it copies two pointers, not the body.
+template <typename Board>
+class SnakeView {
+private:
+    const SnakeBody* body;
+    const Board* board;
+    
+public:
+    class iterator {
+    private:
+        const SnakeBody* body;
+        const Board* board;
+        int i;
+        
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::pair<int, int>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::pair<int, int>;
+        
+        iterator(const SnakeBody* body, const Board* board, int i) : body(body), board(board), i(i) {}
+        std::pair<int, int> operator*() const { return board->position((*body)[i]); }
+        iterator& operator++() { i++; return *this; }
+        iterator operator++(int) { iterator old = *this; i++; return old; }
+        bool operator==(const iterator& other) const { return i == other.i; }
+        bool operator!=(const iterator& other) const { return i != other.i; }
+    };
+    using const_iterator = iterator;
+    using value_type = std::pair<int, int>;
+    
+    SnakeView(const SnakeBody& body, const Board& board) : body(&body), board(&board) {}
+    
+    size_t size() const { return static_cast<size_t>(body->size()); }
+    bool empty() const { return body->empty(); }
+    std::pair<int, int> operator[](int i) const { return board->position((*body)[i]); }
+    std::pair<int, int> front() const { return board->position(body->front()); }
+    std::pair<int, int> back() const { return board->position(body->back()); }
+    iterator begin() const { return iterator(body, board, 0); }
+    iterator end() const { return iterator(body, board, body->size()); }
+    
+    bool operator==(const SnakeView& other) const {
+        return size() == other.size() && std::equal(begin(), end(), other.begin());
+    }
+    bool operator!=(const SnakeView& other) const { return !(*this == other); }
+};
+
+// Headless simulation core: owns the board state and advances it one tick
+// at a time. No terminal I/O, no sleeps and no exit() so it can be driven
+// by the interactive loop as well as by bots at full speed.
+template <typename Board>
+class BasicSnakeEngine {
+private:
+    Board board;
+    char direction;
+    SnakeBody snake;
+    std::pair<int, int> head;
+    std::vector<unsigned char> occupied; // one flag per cell, kept in sync with snake
+    std::vector<int> freeCells;          // indices of every cell not covered by the snake
+    std::vector<int> freeSlot;           // position of each cell in freeCells, -1 when occupied
+    std::vector<int> spareSlot;          // restore() builds the incoming freeSlot here
+    std::pair<int, int> food;
+    std::pair<int, int> poisonFood;
+    int score;
+    bool over;
+    bool won;
+    uint64_t seed;
+    Xoshiro256 rng; // per-instance so independent games never share state
+    
+    int randomBelow(int n) { return rng.below(n); }
+    void pushHead(const std::pair<int, int>& pos);
+    void popTail();
+    void generateFood();
+    void generatePoisonFood();
+    
+public:
+    explicit BasicSnakeEngine(const Board& board = Board(), uint64_t seed = random_seed());
+    
+    // Advance one tick heading in dir (a reversal of the current direction is ignored)
+    TickResult step(char dir);
+    // Start a new game; the same seed and inputs always replay the same game
+    void reset(uint64_t newSeed);
+    void reset();
+    // Replace the snake with body (tail first, each segment adjacent to the
+    // next) heading in dir, then place fresh food. Used to set up puzzles,
+    // tests and benchmarks at a chosen length. Returns false and leaves the
+    // game untouched if a segment is off the board or repeated.
+    bool placeSnake(const std::vector<std::pair<int, int>>& body, char dir);
+    // Move the food to a new random free cell
+    void respawnFood() { generateFood(); }
+    // Bytes written by snapshot()
+    size_t snapshotSize() const { return snapshot_size(board.cells()); }
+    // Copy the complete game state into out, snapshotSize() bytes laid out
+    // as described in snapshot.h. Never allocates, so search code can
+    // checkpoint into a reused buffer as often as it likes.
+    void snapshot(void* out) const;
+    // Continue from a snapshot taken on a board of the same size. Returns
+    // false without touching the game if data is not such a snapshot, or
+    // false with a fresh game if its cell lists are corrupt.
+    bool restore(const void* data, size_t size);
+    bool isOver() const { return over; }
+    bool isWon() const { return won; }
+    int freeCellCount() const { return static_cast<int>(freeCells.size()); }
+    // O(1) check whether a body segment covers pos
+    bool isOccupied(const std::pair<int, int>& pos) const { return occupied[board.index(pos)] != 0; }
+    bool isOccupied(int cell) const { return occupied[cell] != 0; }
+    
+    // Getters
+    const Board& getBoard() const { return board; }
+    uint64_t getSeed() const { return seed; }
+    int getScore() const { return score; }
+    char getDirection() const { return direction; }
+    SnakeView<Board> getSnake() const { return SnakeView<Board>(snake, board); }
+    const SnakeBody& getBody() const { return snake; }
+    std::pair<int, int> getHead() const { return head; }
+    std::pair<int, int> getFood() const { return food; }
+    std::pair<int, int> getPoisonFood() const { return poisonFood; }
+    
+    // Setters
+    void setDirection(char dir) { direction = dir; }
+};
+
+using SnakeEngine = BasicSnakeEngine<DynamicBoard>;
+
+// Autopilot that plays a game by choosing each tick's direction from the
+// engine state. Implementations live in agent.h.
+class Agent {
+public:
+    virtual ~Agent() = default;
+    // Called before each game with a seed for any randomness the agent uses
+    virtual void reset(uint64_t seed) { (void)seed; }
+    // Direction for the next tick
+    virtual char chooseMove(const SnakeEngine& engine) = 0;
+};
+
+// Utility functions
+std::pair<int, int> get_next_head(const std::pair<int, int>& current, char direction,
+                                  int width = BOARD_SIZE, int height = BOARD_SIZE);
+// Called per candidate move by the agents, so kept inline
+inline bool is_reverse(char current, char next) {
+    return (current ^ next) == 1;
+}
+
+inline int direction_index(char dir) {
+    return dir & 3;
+}
+
+const char* tick_result_name(TickResult result);
+
+
+// Board geometry implementation
+inline std::pair<int, int> DynamicBoard::next(const std::pair<int, int>& current, char dir) const {
+    std::pair<int, int> next = current;
+    if (dir == DIR_RIGHT) {
+        next.second = current.second + 1 == w ? 0 : current.second + 1;
+    } else if (dir == DIR_LEFT) {
+        next.second = current.second == 0 ? w - 1 : current.second - 1;
+    } else if (dir == DIR_DOWN) {
+        next.first = current.first + 1 == h ? 0 : current.first + 1;
+    } else if (dir == DIR_UP) {
+        next.first = current.first == 0 ? h - 1 : current.first - 1;
+    }
+    return next;
+}
+
+template <int W, int H>
+std::pair<int, int> FixedBoard<W, H>::next(const std::pair<int, int>& current, char dir) const {
+    std::pair<int, int> next = current;
+    if constexpr (POWER_OF_TWO) {
+        if (dir == DIR_RIGHT) {
+            next.second = (current.second + 1) & (W - 1);
+        } else if (dir == DIR_LEFT) {
+            next.second = (current.second - 1) & (W - 1);
+        } else if (dir == DIR_DOWN) {
+            next.first = (current.first + 1) & (H - 1);
+        } else if (dir == DIR_UP) {
+            next.first = (current.first - 1) & (H - 1);
+        }
+    } else {
+        if (dir == DIR_RIGHT) {
+            next.second = current.second + 1 == W ? 0 : current.second + 1;
+        } else if (dir == DIR_LEFT) {
+            next.second = current.second == 0 ? W - 1 : current.second - 1;
+        } else if (dir == DIR_DOWN) {
+            next.first = current.first + 1 == H ? 0 : current.first + 1;
+        } else if (dir == DIR_UP) {
+            next.first = current.first == 0 ? H - 1 : current.first - 1;
+        }
+    }
+    return next;
+}
+
+// SnakeEngine class implementation
+template <typename Board>
+BasicSnakeEngine<Board>::BasicSnakeEngine(const Board& board, uint64_t seed) : board(board) {
+    reset(seed);
+}
+
+template <typename Board>
+void BasicSnakeEngine<Board>::reset() {
+    reset(random_seed());
+}
+
+template <typename Board>
+void BasicSnakeEngine<Board>::reset(uint64_t newSeed) {
+    seed = newSeed;
+    rng.reseed(newSeed);
+    direction = DIR_RIGHT;
+    score = 0;
+    over = false;
+    won = false;
+    snake.reset(board.cells());
+    occupied.assign(board.cells(), 0);
+    freeCells.resize(board.cells());
+    freeSlot.resize(board.cells());
+    spareSlot.resize(board.cells());
+    for (int i = 0; i < board.cells(); i++) {
+        freeCells[i] = i;
+        freeSlot[i] = i;
+    }
+    pushHead(std::make_pair(0, 0));
+    generateFood();
+    poisonFood = std::make_pair(-1, -1);
+}
+
+template <typename Board>
+bool BasicSnakeEngine<Board>::placeSnake(const std::vector<std::pair<int, int>>& body, char dir) {
+    if (body.empty() || static_cast<int>(body.size()) > board.cells()) {
+        return false;
+    }
+    std::vector<unsigned char> seen(board.cells(), 0);
+    for (const auto& pos : body) {
+        if (pos.first < 0 || pos.first >= board.height() || pos.second < 0 || pos.second >= board.width() ||
+            seen[board.index(pos)]) {
+            return false;
+        }
+        seen[board.index(pos)] = 1;
+    }
+    
+    direction = dir;
+    over = false;
+    won = false;
+    snake.reset(board.cells());
+    occupied.assign(board.cells(), 0);
+    freeCells.resize(board.cells());
+    for (int i = 0; i < board.cells(); i++) {
+        freeCells[i] = i;
+        freeSlot[i] = i;
+    }
+    for (const auto& pos : body) {
+        pushHead(pos);
+    }
+    score = (snake.size() - 1) * 10; // as if the last segment had just been eaten
+    generateFood();
+    poisonFood = std::make_pair(-1, -1);
+    return true;
+}
+
+template <typename Board>
+void BasicSnakeEngine<Board>::pushHead(const std::pair<int, int>& pos) {
+    int idx = board.index(pos);
+    snake.pushBack(idx);
+    head = pos;
+    occupied[idx] = 1;
+    
+    // Swap-remove the cell from the free list
+    int slot = freeSlot[idx];
+    int last = freeCells.back();
+    freeCells[slot] = last;
+    freeSlot[last] = slot;
+    freeCells.pop_back();
+    freeSlot[idx] = -1;
+}
+
+template <typename Board>
+void BasicSnakeEngine<Board>::popTail() {
+    int idx = snake.front();
+    occupied[idx] = 0;
+    freeSlot[idx] = static_cast<int>(freeCells.size());
+    freeCells.push_back(idx);
+    snake.popFront();
+}
+
+// Both generators sample the free list directly, so placement is O(1)
+// and uniform no matter how much of the board the snake covers.
+template <typename Board>
+void BasicSnakeEngine<Board>::generateFood() {
+    SNAKE_PROFILE_SCOPE(PROFILE_FOOD);
+    if (freeCells.empty()) {
+        food = std::make_pair(-1, -1);
+        return;
+    }
+    food = board.position(freeCells[randomBelow(static_cast<int>(freeCells.size()))]);
+}
+
+template <typename Board>
+void BasicSnakeEngine<Board>::generatePoisonFood() {
+    SNAKE_PROFILE_SCOPE(PROFILE_FOOD);
+    // Food sits on a free cell, so draw from the other n - 1 and let the
+    // last slot stand in for whichever slot holds the food.
+    int candidates = static_cast<int>(freeCells.size()) - 1;
+    if (candidates <= 0) {
+        poisonFood = std::make_pair(-1, -1);
+        return;
+    }
+    int idx = freeCells[randomBelow(candidates)];
+    if (idx == board.index(food)) {
+        idx = freeCells[candidates];
+    }
+    poisonFood = board.position(idx);
+}
+
+template <typename Board>
+void BasicSnakeEngine<Board>::snapshot(void* out) const {
+    EngineSnapshot header = {};
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.flags = static_cast<uint16_t>((over ? SNAPSHOT_OVER : 0) | (won ? SNAPSHOT_WON : 0));
+    header.width = board.width();
+    header.height = board.height();
+    header.seed = seed;
+    rng.getState(header.rng);
+    header.score = score;
+    header.direction = direction;
+    header.food = food.first >= 0 ? board.index(food) : -1;
+    header.poison = poisonFood.first >= 0 ? board.index(poisonFood) : -1;
+    header.length = snake.size();
+    
+    char* bytes = static_cast<char*>(out);
+    std::memcpy(bytes, &header, sizeof(header));
+    int32_t* cells = reinterpret_cast<int32_t*>(bytes + sizeof(header));
+    snake.copyTo(cells);
+    std::memcpy(cells + snake.size(), freeCells.data(), sizeof(int32_t) * freeCells.size());
+}
+
+template <typename Board>
+bool BasicSnakeEngine<Board>::restore(const void* data, size_t size) {
+    const int n = board.cells();
+    EngineSnapshot header;
+    if (size != snapshotSize()) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION || header.width != board.width() ||
+        header.height != board.height() || header.length < 1 || header.length > n ||
+        header.direction < 0 || header.direction > 3 || header.food < -1 || header.food >= n ||
+        header.poison < -1 || header.poison >= n) {
+        return false;
+    }
+    
+    const int32_t* cells = reinterpret_cast<const int32_t*>(static_cast<const char*>(data) + sizeof(header));
+    // Build the free-slot table in the spare one, so a blob that fails the
+    // checks leaves the live game untouched; every cell must appear exactly once
+    std::fill(spareSlot.begin(), spareSlot.end(), -2);
+    for (int i = 0; i < n; i++) {
+        int cell = cells[i];
+        if (cell < 0 || cell >= n || spareSlot[cell] != -2) {
+            return false;
+        }
+        spareSlot[cell] = i < header.length ? -1 : i - header.length;
+    }
+    // Food and poison sit on free cells, never on the same one
+    if ((header.food >= 0 && spareSlot[header.food] < 0) || (header.poison >= 0 && spareSlot[header.poison] < 0) ||
+        (header.food == header.poison && header.food != -1)) {
+        return false;
+    }
+    
+    snake.assign(cells, header.length);
+    freeCells.assign(cells + header.length, cells + n);
+    freeSlot.swap(spareSlot);
+    for (int cell = 0; cell < n; cell++) {
+        occupied[cell] = freeSlot[cell] < 0 ? 1 : 0;
+    }
+    seed = header.seed;
+    rng.setState(header.rng);
+    score = header.score;
+    direction = static_cast<char>(header.direction);
+    over = (header.flags & SNAPSHOT_OVER) != 0;
+    won = (header.flags & SNAPSHOT_WON) != 0;
+    head = board.position(snake.back());
+    food = header.food >= 0 ? board.position(header.food) : std::make_pair(-1, -1);
+    poisonFood = header.poison >= 0 ? board.position(header.poison) : std::make_pair(-1, -1);
+    return true;
+}
+
+template <typename Board>
+TickResult BasicSnakeEngine<Board>::step(char dir) {
+    if (!is_reverse(direction, dir)) {
+        direction = dir;
+    }
+    
+    std::pair<int, int> next = board.next(head, direction);
+    score = snake.size() * 10;
+    
+    if (isOccupied(next)) {
+        over = true;
+        return TickResult::HitSelf;
+    }
+    
+    if (next == food) {
+        // Occupy the new head first so the next food cannot spawn under it
+        pushHead(next);
+        if (freeCells.empty()) {
+            food = std::make_pair(-1, -1);
+            poisonFood = std::make_pair(-1, -1);
+            over = true;
+            won = true;
+            return TickResult::Won;
+        }
+        generateFood();
+        
+        if (randomBelow(POISON_CHANCE) == 0) {
+            generatePoisonFood();
+        } else {
+            poisonFood = std::make_pair(-1, -1);
+        }
+        return TickResult::Ate;
+    } else if (next == poisonFood) {
+        over = true;
+        return TickResult::Poisoned;
+    }
+    
+    pushHead(next);
+    popTail();
+    return TickResult::Moved;
+}
+
+// The runtime-sized engine is compiled once, in engine.cpp
+extern template class BasicSnakeEngine<DynamicBoard>;
+
+#endif
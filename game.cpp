@@ -0,0 +1,296 @@
+#include "snake.h"
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+static int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// SnakeGame class implementation
+SnakeGame::SnakeGame(const GameConfig& config)
+    : engine(DynamicBoard(config.width, config.height), config.seed), paused(false), finished(false),
+      logPath(config.logPath), startedNs(0), steps(0), pendingCount(0), lastInputLatencyNs(0), keys(config.keys),
+      speed(config.speed) {
+    // Scores from before the log existed keep their place on the leaderboard
+    if (!import_score_file(logPath, config.scoresPath, MAX_TOP_SCORES)) {
+        std::cerr << "Warning: Could not import " << config.scoresPath << " into " << logPath << std::endl;
+    }
+    if (!config.recordPath.empty()) {
+        ReplayHeader header;
+        header.seed = engine.getSeed();
+        header.width = config.width;
+        header.height = config.height;
+        if (!recorder.open(config.recordPath, header)) {
+            std::cerr << "Warning: Could not record replay to " << config.recordPath << std::endl;
+        }
+    }
+}
+
+void SnakeGame::showTopScores() {
+    std::cout << "\n=== Top Scores ===\n";
+    int count = 0;
+    // Straight from the log's index; only games since it was built are scanned
+    for (int s : top_game_scores(logPath, MAX_TOP_SCORES)) {
+        std::cout << ++count << ". " << s << std::endl;
+    }
+    std::cout << "==================\n";
+}
+
+void SnakeGame::renderGame(const std::vector<std::string>& status) {
+    {
+        SNAKE_PROFILE_SCOPE(PROFILE_RENDER);
+        renderer.render(engine, status);
+    }
+    SNAKE_PROFILE_SCOPE(PROFILE_PRESENT);
+    renderer.present();
+}
+
+bool SnakeGame::isValidPosition(const std::pair<int, int>& pos) {
+    const DynamicBoard& board = engine.getBoard();
+    return pos.first >= 0 && pos.first < board.height() && 
+           pos.second >= 0 && pos.second < board.width();
+}
+
+void SnakeGame::gameOver(const std::string& reason, TickResult result) {
+    renderer.clearScreen();
+    std::cout << "Game Over! " << reason << std::endl;
+    std::cout << "Final Score: " << engine.getScore() << " points\n";
+    std::cout << "Seed: " << engine.getSeed() << "\n";
+    const TickBudgetStats& ticks = budget.getStats();
+    if (ticks.missedDeadlines > 0) {
+        std::cout << "Missed tick deadlines: " << ticks.missedDeadlines << " of " << ticks.ticks
+                  << " (" << ticks.skippedFrames << " frames skipped, slowest tick "
+                  << ticks.maxWorkNs / 1000000 << " ms)\n";
+    }
+    
+    GameRecord record = {};
+    record.seed = engine.getSeed();
+    record.endedAt = static_cast<int64_t>(std::time(nullptr));
+    record.durationMs = startedNs > 0 ? (steady_now_ns() - startedNs) / 1000000 : 0;
+    record.ticks = steps;
+    record.score = engine.getScore();
+    record.length = static_cast<int32_t>(engine.getSnake().size());
+    // Sides are capped at MAX_BOARD_SIDE, which game_log.h checks fits
+    record.width = static_cast<uint16_t>(engine.getBoard().width());
+    record.height = static_cast<uint16_t>(engine.getBoard().height());
+    record.result = static_cast<uint8_t>(result);
+    if (!append_game_record(logPath, record)) {
+        std::cerr << "Warning: Could not save the game to " << logPath << std::endl;
+    }
+    if (!refresh_game_index(logPath, GAME_INDEX_LAG)) {
+        std::cerr << "Warning: Could not index " << logPath << std::endl;
+    }
+    showTopScores();
+    recorder.close();
+    finished = true;
+}
+
+int SnakeGame::calculateDelay() {
+    return speed.delayMs(engine.getSnake().size());
+}
+
+void SnakeGame::startGame() {
+    renderer.clearScreen();
+    showTopScores();
+}
+
+void SnakeGame::handleInput(char input) {
+    applyAction(decoder.feed(keys, static_cast<unsigned char>(input)));
+}
+
+void SnakeGame::applyAction(InputAction action) {
+    if (action <= INPUT_DOWN) {
+        // Prevent snake from moving backwards into itself
+        if (!is_reverse(engine.getDirection(), action)) {
+            engine.setDirection(action);
+        }
+    } else if (action == INPUT_PAUSE) {
+        paused = !paused;
+    } else if (action == INPUT_QUIT) {
+        // Quitting records no score. The destructor may never run, so the
+        // replay is finished off here.
+        recorder.close();
+        finished = true;
+    }
+}
+
+bool SnakeGame::postInput(char input) {
+    return inputQueue.push(InputEvent{input, steady_now_ns()});
+}
+
+void SnakeGame::drainInput() {
+    SNAKE_PROFILE_SCOPE(PROFILE_INPUT);
+    InputEvent event;
+    while (inputQueue.pop(event)) {
+        InputAction action = decoder.feed(keys, static_cast<unsigned char>(event.key));
+        if (action == INPUT_PAUSE || action == INPUT_QUIT) {
+            applyAction(action);
+        } else if (action <= INPUT_DOWN && pendingCount < MAX_PENDING_TURNS) {
+            pendingTurns[pendingCount++] = PendingTurn{static_cast<char>(action), event.timestampNs};
+        }
+    }
+}
+
+bool SnakeGame::applyPendingTurn() {
+    // Turns that would not change direction (repeats, reversals) are dropped
+    // so they do not use up the tick's turn
+    while (pendingCount > 0) {
+        PendingTurn turn = pendingTurns[0];
+        std::copy(pendingTurns + 1, pendingTurns + pendingCount, pendingTurns);
+        pendingCount--;
+        
+        char before = engine.getDirection();
+        applyAction(static_cast<InputAction>(turn.direction));
+        if (engine.getDirection() != before) {
+            lastInputLatencyNs = steady_now_ns() - turn.timestampNs;
+            SNAKE_PROFILE_RECORD(PROFILE_INPUT_LATENCY, lastInputLatencyNs);
+            return true;
+        }
+    }
+    return false;
+}
+
+void SnakeGame::tick() {
+    int64_t now = steady_now_ns();
+    if (startedNs == 0) startedNs = now;
+    budget.beginTick(now);
+    advance(budget.shouldRender());
+    budget.endTick(steady_now_ns(), static_cast<int64_t>(tickDelayMs()) * 1000000LL);
+}
+
+void SnakeGame::advance(bool draw) {
+    if (SNAKE_PROFILE_POLL()) {
+        // The dump scribbled over the board; draw the next frame in full
+        renderer.invalidate();
+    }
+    SNAKE_PROFILE_SCOPE(PROFILE_TICK);
+    drainInput();
+    if (finished) {
+        return;
+    }
+    if (paused) {
+        if (draw) renderGame({"Game paused. Press x to continue",
+                    "Score: " + std::to_string(engine.getScore()) + " points"});
+        return;
+    }
+    
+    if (agent) {
+        pendingCount = 0;
+        SNAKE_PROFILE_SCOPE(PROFILE_AGENT);
+        char dir = agent->chooseMove(engine);
+        if (!is_reverse(engine.getDirection(), dir)) {
+            engine.setDirection(dir);
+        }
+    } else {
+        applyPendingTurn();
+    }
+    TickResult result;
+    {
+        SNAKE_PROFILE_SCOPE(PROFILE_STEP);
+        result = engine.step(engine.getDirection());
+    }
+    steps++;
+    recorder.record(static_cast<uint8_t>(direction_index(engine.getDirection())));
+    if (result == TickResult::HitSelf) {
+        gameOver("You hit yourself!", result);
+        return;
+    } else if (result == TickResult::Poisoned) {
+        gameOver("You ate poisonous food!", result);
+        return;
+    } else if (result == TickResult::Won) {
+        gameOver("You filled the board!", result);
+        return;
+    }
+    
+    if (!draw) {
+        return;
+    }
+    renderGame({"length of snake: " + std::to_string(engine.getSnake().size()),
+                "Score: " + std::to_string(engine.getScore()) + " points"});
+}
+
+int SnakeGame::tickDelayMs() {
+    return paused ? PAUSED_DELAY_MS : calculateDelay();
+}
+
+int64_t SnakeGame::tickSleepNs() {
+    return budget.sleepNs(steady_now_ns());
+}
+
+void SnakeGame::updateGame() {
+    tick();
+    if (!finished) {
+        int64_t sleepNs = tickSleepNs();
+        SNAKE_PROFILE_SCOPE(PROFILE_SLEEP);
+        std::this_thread::sleep_for(std::chrono::nanoseconds(sleepNs));
+    }
+}
+
+void SnakeGame::pauseGame() {
+    paused = true;
+}
+
+void SnakeGame::resumeGame() {
+    paused = false;
+}
+
+bool SnakeGame::isGameOver() {
+    return finished || engine.isOver();
+}
+
+void SnakeGame::setAgent(std::unique_ptr<Agent> autopilot) {
+    agent = std::move(autopilot);
+    if (agent) {
+        agent->reset(engine.getSeed());
+    }
+}
+
+int delay_for_length(size_t length) {
+    return SpeedCurve::stepped().delayMs(length);
+}
+
+int replay_game(const std::string& path, double rate) {
+    ReplayReader reader;
+    if (!reader.load(path)) {
+        std::cerr << "Error: " << path << " is not a readable replay" << std::endl;
+        return 1;
+    }
+    const ReplayHeader& header = reader.header();
+    SnakeEngine engine(DynamicBoard(header.width, header.height), header.seed);
+    std::vector<uint8_t> dirs = reader.directions();
+    
+    TerminalRenderer renderer;
+    if (rate > 0) {
+        renderer.clearScreen();
+    }
+    
+    TickResult result = TickResult::Moved;
+    uint64_t tick = 0;
+    TickBudget budget;
+    while (tick < dirs.size() && !engine.isOver()) {
+        if (rate > 0) budget.beginTick(steady_now_ns());
+        result = engine.step(DIRECTIONS[dirs[tick++]]);
+        if (rate > 0) {
+            if (budget.shouldRender()) {
+                renderer.render(engine, {"Replay tick " + std::to_string(tick) + "/" + std::to_string(dirs.size()),
+                                         "Score: " + std::to_string(engine.getScore()) + " points"});
+                renderer.present();
+            }
+            double intervalMs = delay_for_length(engine.getSnake().size()) / rate;
+            budget.endTick(steady_now_ns(), static_cast<int64_t>(intervalMs * 1e6));
+            std::this_thread::sleep_for(std::chrono::nanoseconds(budget.sleepNs(steady_now_ns())));
+        }
+    }
+    
+    std::cout << "\n=== Replay ===\n";
+    std::cout << "seed: " << header.seed << "\n";
+    std::cout << "board: " << header.width << "x" << header.height << "\n";
+    std::cout << "ticks: " << tick << "/" << dirs.size() << "\n";
+    std::cout << "last tick: " << tick_result_name(result) << "\n";
+    std::cout << "length: " << engine.getSnake().size() << "\n";
+    std::cout << "score: " << engine.getScore() << std::endl;
+    return 0;
+}
@@ -0,0 +1,263 @@
+#include "game_log.h"
+#include "score_store.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Index order: best score first, ties oldest first
+static bool index_before(const GameIndexEntry& a, const GameIndexEntry& b) {
+    return a.score != b.score ? a.score > b.score : a.record < b.record;
+}
+
+static GameLogHeader log_header() {
+    GameLogHeader header = {};
+    header.magic = GAME_LOG_MAGIC;
+    header.version = GAME_LOG_VERSION;
+    header.recordSize = sizeof(GameRecord);
+    return header;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+static bool write_all(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// Append count records in one locked write. With onlyNew they are only
+// written to a log that has no records yet.
+static bool append_records(const std::string& path, const GameRecord* records, size_t count, bool onlyNew) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    while (::flock(fd, LOCK_EX) != 0 && errno == EINTR) {}
+    bool ok = false;
+    struct stat info;
+    if (::fstat(fd, &info) == 0) {
+        const off_t size = info.st_size;
+        const GameLogHeader expected = log_header();
+        if (size == 0) {
+            ok = write_all(fd, &expected, sizeof(expected));
+        } else if (onlyNew) {
+            count = 0; // another game started the log first
+            ok = true;
+        } else if (size >= static_cast<off_t>(sizeof(GameLogHeader))) {
+            // Never append to something that is not a log of this layout
+            GameLogHeader header;
+            ok = ::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                 std::memcmp(&header, &expected, sizeof(header)) == 0;
+            // Drop the remains of a record torn by a crash
+            off_t torn = (size - static_cast<off_t>(sizeof(GameLogHeader))) % static_cast<off_t>(sizeof(GameRecord));
+            if (ok && torn != 0) {
+                ok = ::ftruncate(fd, size - torn) == 0;
+            }
+        }
+        ok = ok && write_all(fd, records, sizeof(GameRecord) * count);
+    }
+    ::flock(fd, LOCK_UN);
+    ::close(fd);
+    return ok;
+}
+#else
+static bool append_records(const std::string& path, const GameRecord* records, size_t count, bool onlyNew) {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    if (!out.is_open()) {
+        return false;
+    }
+    out.seekp(0, std::ios::end);
+    if (out.tellp() == 0) {
+        const GameLogHeader header = log_header();
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    } else if (onlyNew) {
+        return true;
+    }
+    out.write(reinterpret_cast<const char*>(records), static_cast<std::streamsize>(sizeof(GameRecord) * count));
+    out.flush();
+    return out.good();
+}
+#endif
+
+bool append_game_record(const std::string& path, const GameRecord& record) {
+    return append_records(path, &record, 1, false);
+}
+
+bool import_score_file(const std::string& logPath, const std::string& scoresPath, size_t limit) {
+    if (std::ifstream(logPath).is_open()) {
+        return true; // the usual case: imported or played before
+    }
+    ScoreStore old(scoresPath, limit);
+    old.load();
+    std::vector<int> scores = old.top();
+    if (scores.empty()) {
+        return true;
+    }
+    std::vector<GameRecord> records(scores.size());
+    for (size_t i = 0; i < scores.size(); i++) {
+        records[i].score = scores[i];
+        records[i].result = GAME_RESULT_IMPORTED;
+    }
+    return append_records(logPath, records.data(), records.size(), true);
+}
+
+// GameLog class implementation
+bool GameLog::open(const std::string& path) {
+    close();
+    if (!file.open(path) || file.size() < sizeof(GameLogHeader)) {
+        file.close();
+        return false;
+    }
+    const GameLogHeader expected = log_header();
+    if (std::memcmp(file.data(), &expected, sizeof(expected)) != 0) {
+        file.close();
+        return false;
+    }
+    const char* bytes = static_cast<const char*>(file.data());
+    first = reinterpret_cast<const GameRecord*>(bytes + sizeof(GameLogHeader));
+    count = (file.size() - sizeof(GameLogHeader)) / sizeof(GameRecord);
+    return true;
+}
+
+void GameLog::close() {
+    file.close();
+    first = nullptr;
+    count = 0;
+}
+
+// GameIndex class implementation
+bool GameIndex::open(const std::string& path) {
+    close();
+    if (!file.open(path) || file.size() < sizeof(GameIndexHeader)) {
+        file.close();
+        return false;
+    }
+    GameIndexHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    const size_t entries = (file.size() - sizeof(GameIndexHeader)) / sizeof(GameIndexEntry);
+    if (header.magic != GAME_INDEX_MAGIC || header.version != GAME_INDEX_VERSION ||
+        header.entrySize != sizeof(GameIndexEntry) || header.records != entries) {
+        file.close();
+        return false;
+    }
+    const char* bytes = static_cast<const char*>(file.data());
+    first = reinterpret_cast<const GameIndexEntry*>(bytes + sizeof(GameIndexHeader));
+    count = entries;
+    covered = header.records;
+    firstSeed = header.firstSeed;
+    firstEndedAt = header.firstEndedAt;
+    return true;
+}
+
+void GameIndex::close() {
+    file.close();
+    first = nullptr;
+    count = 0;
+    covered = 0;
+    firstSeed = 0;
+    firstEndedAt = 0;
+}
+
+bool GameIndex::builtFrom(const GameLog& log) const {
+    if (covered > log.size()) {
+        return false;
+    }
+    return covered == 0 || (log[0].seed == firstSeed && log[0].endedAt == firstEndedAt);
+}
+
+std::pair<const GameIndexEntry*, const GameIndexEntry*> GameIndex::scoreRange(int32_t lo, int32_t hi) const {
+    const GameIndexEntry* from =
+        std::partition_point(begin(), end(), [hi](const GameIndexEntry& e) { return e.score > hi; });
+    if (lo > hi) {
+        return std::make_pair(from, from);
+    }
+    const GameIndexEntry* to =
+        std::partition_point(from, end(), [lo](const GameIndexEntry& e) { return e.score >= lo; });
+    return std::make_pair(from, to);
+}
+
+bool update_game_index(const std::string& logPath) {
+    // Serializes index writers, which share one temp file name
+    ScoreFileLock lock(logPath + ".lock");
+    GameLog log;
+    if (!log.open(logPath)) {
+        return false;
+    }
+    const std::string indexPath = game_index_path(logPath);
+    GameIndex old;
+    if (!old.open(indexPath) || !old.builtFrom(log)) {
+        old.close(); // missing, damaged or from another log: start over
+    } else if (old.records() == log.size()) {
+        return true;
+    }
+
+    std::vector<GameIndexEntry> fresh;
+    fresh.reserve(log.size() - old.records());
+    for (size_t i = old.records(); i < log.size(); i++) {
+        fresh.push_back(GameIndexEntry{log[i].score, static_cast<uint32_t>(i)});
+    }
+    std::sort(fresh.begin(), fresh.end(), index_before);
+
+    GameIndexHeader header = {};
+    header.magic = GAME_INDEX_MAGIC;
+    header.version = GAME_INDEX_VERSION;
+    header.entrySize = sizeof(GameIndexEntry);
+    header.records = log.size();
+    if (log.size() > 0) {
+        header.firstSeed = log[0].seed;
+        header.firstEndedAt = log[0].endedAt;
+    }
+    std::vector<char> out(sizeof(header) + sizeof(GameIndexEntry) * log.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+    // Older records come from the old index, so on equal scores they stay first
+    std::merge(old.begin(), old.end(), fresh.begin(), fresh.end(),
+               reinterpret_cast<GameIndexEntry*>(out.data() + sizeof(header)), index_before);
+    old.close();
+    return write_snapshot_file(indexPath, out.data(), out.size());
+}
+
+bool refresh_game_index(const std::string& logPath, size_t maxLag) {
+    GameLog log;
+    if (!log.open(logPath)) {
+        return false;
+    }
+    GameIndex index;
+    if (index.open(game_index_path(logPath)) && index.builtFrom(log) && log.size() - index.records() <= maxLag) {
+        return true;
+    }
+    return update_game_index(logPath);
+}
+
+std::vector<int> top_game_scores(const std::string& logPath, size_t k) {
+    TopScores top(k);
+    GameLog log;
+    if (!log.open(logPath)) {
+        return top.sorted();
+    }
+    size_t from = 0;
+    GameIndex index;
+    if (index.open(game_index_path(logPath)) && index.builtFrom(log)) {
+        for (size_t i = 0; i < std::min(k, index.size()); i++) {
+            top.insert(index.begin()[i].score);
+        }
+        from = index.records();
+    }
+    for (size_t i = from; i < log.size(); i++) {
+        top.insert(log[i].score);
+    }
+    return top.sorted();
+}
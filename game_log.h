@@ -0,0 +1,146 @@
+#ifndef GAME_LOG_H
+#define GAME_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "board_limits.h"
+#include "snapshot.h"
+
+// Append-only log of every finished game: a small header followed by
+// fixed-size records in native byte order, one per game, oldest first.
+// Readers map the file and use the records in place, so scanning millions
+// of games involves no parsing at all. A record is appended with a single
+// write under an exclusive flock, so games sharing a log never interleave;
+// a record torn by a crash is cut off by the next append.
+const uint32_t GAME_LOG_MAGIC = 0x474b4e53; // "SNKG" when read little-endian
+const uint32_t GAME_INDEX_MAGIC = 0x494b4e53; // "SNKI"
+const uint16_t GAME_LOG_VERSION = 1;
+const uint16_t GAME_INDEX_VERSION = 1;
+
+struct GameLogHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize; // sizeof(GameRecord), so a reader can reject foreign layouts
+    uint32_t reserved[2];
+};
+
+struct GameRecord {
+    uint64_t seed;       // replays the game with --seed
+    int64_t endedAt;     // Unix time in seconds
+    int64_t durationMs;  // wall time from first to last tick, pauses included
+    uint64_t ticks;      // engine steps taken
+    int32_t score;
+    int32_t length;      // body segments at the end
+    uint16_t width;
+    uint16_t height;
+    uint8_t result;      // the TickResult that ended the game
+    uint8_t reserved[3];
+};
+// GameRecord::result of a score carried over from a scores.txt leaderboard;
+// nothing but the score is known about such a game
+const uint8_t GAME_RESULT_IMPORTED = 0xff;
+static_assert(std::is_trivially_copyable<GameRecord>::value, "records are copied as raw bytes");
+static_assert(sizeof(GameLogHeader) == 16, "log header layout is part of the file format");
+static_assert(sizeof(GameRecord) == 48, "record layout is part of the file format");
+static_assert(MAX_BOARD_SIDE <= UINT16_MAX, "GameRecord stores board sides as uint16_t");
+
+// Append one record to the log at path, creating it if needed
+bool append_game_record(const std::string& path, const GameRecord& record);
+
+// Start the log at logPath with the best limit scores of the old scores.txt
+// leaderboard at scoresPath, one GAME_RESULT_IMPORTED record each, so an
+// upgrade keeps the leaderboard. Does nothing once the log has any records,
+// so the scores are carried over once; false only if writing them failed.
+bool import_score_file(const std::string& logPath, const std::string& scoresPath, size_t limit);
+
+// Read-only mapped view of a game log
+class GameLog {
+private:
+    SnapshotFile file; // any read-only file mapping will do
+    const GameRecord* first;
+    size_t count;
+
+public:
+    GameLog() : first(nullptr), count(0) {}
+
+    // Map the log at path; false if it is missing or not a game log. A torn
+    // last record is left out.
+    bool open(const std::string& path);
+    void close();
+    size_t size() const { return count; }
+    const GameRecord& operator[](size_t i) const { return first[i]; }
+    const GameRecord* begin() const { return first; }
+    const GameRecord* end() const { return first + count; }
+};
+
+// Index entry: one per game, sorted by score, best first, ties oldest first
+struct GameIndexEntry {
+    int32_t score;
+    uint32_t record; // position in the log
+};
+
+struct GameIndexHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entrySize;
+    uint64_t records; // log records covered; later ones are not indexed yet
+    // The log's first record, so an index left behind by a log that was
+    // rotated or deleted is not trusted for the next one
+    uint64_t firstSeed;
+    int64_t firstEndedAt;
+};
+static_assert(sizeof(GameIndexHeader) == 32, "index header layout is part of the file format");
+static_assert(sizeof(GameIndexEntry) == 8, "index entry layout is part of the file format");
+
+// Sidecar index for the log at logPath
+inline std::string game_index_path(const std::string& logPath) {
+    return logPath + ".idx";
+}
+
+// Read-only mapped view of a game index. Top-K is the first K entries and a
+// score range is two binary searches.
+class GameIndex {
+private:
+    SnapshotFile file;
+    const GameIndexEntry* first;
+    size_t count;
+    uint64_t covered;
+    uint64_t firstSeed;
+    int64_t firstEndedAt;
+
+public:
+    GameIndex() : first(nullptr), count(0), covered(0), firstSeed(0), firstEndedAt(0) {}
+
+    bool open(const std::string& path);
+    void close();
+    size_t size() const { return count; }
+    // Log records the index was built from
+    uint64_t records() const { return covered; }
+    // True if the index was built from (a prefix of) this log
+    bool builtFrom(const GameLog& log) const;
+    const GameIndexEntry* begin() const { return first; }
+    const GameIndexEntry* end() const { return first + count; }
+    // Entries with lo <= score <= hi, best first
+    std::pair<const GameIndexEntry*, const GameIndexEntry*> scoreRange(int32_t lo, int32_t hi) const;
+};
+
+// Bring the index of the log at logPath up to date, merging records added
+// since it was last built into the existing entries. The new index is
+// written to a temp file and renamed into place under the log's lock file.
+bool update_game_index(const std::string& logPath);
+
+// Records a game may leave unindexed before it updates the index itself
+const size_t GAME_INDEX_LAG = 256;
+
+// update_game_index once more than maxLag records are missing from the index
+bool refresh_game_index(const std::string& logPath, size_t maxLag);
+
+// Best k scores in the log, best first: the head of the index plus any
+// records appended since it was built
+std::vector<int> top_game_scores(const std::string& logPath, size_t k);
+
+#endif
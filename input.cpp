@@ -0,0 +1,164 @@
+#include "snake.h"
+#include <cerrno>
+#include <iostream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/timerfd.h>
+#endif
+
+SnakeGame* g_game = nullptr;
+
+InputAction KeyDecoder::feed(const KeyMap& keys, unsigned char byte) {
+    if (state == ESCAPE) {
+        if (byte == '[' || byte == 'O') {
+            state = SEQUENCE;
+            return INPUT_NONE;
+        }
+        state = GROUND; // a lone ESC: treat this byte as an ordinary key
+    } else if (state == SEQUENCE) {
+        if (byte >= 0x30 && byte <= 0x3F) {
+            return INPUT_NONE; // parameter bytes, e.g. modifiers in ESC [ 1 ; 5 A
+        }
+        state = GROUND;
+        switch (byte) {
+            case 'A': return INPUT_UP;
+            case 'B': return INPUT_DOWN;
+            case 'C': return INPUT_RIGHT;
+            case 'D': return INPUT_LEFT;
+            default: return INPUT_NONE;
+        }
+    }
+    if (byte == 0x1B) {
+        state = ESCAPE;
+        return INPUT_NONE;
+    }
+    return keys.lookup(byte);
+}
+
+bool parse_key_bindings(const std::string& spec, KeyMap& keys) {
+    static const InputAction ORDER[] = {INPUT_UP, INPUT_LEFT, INPUT_DOWN, INPUT_RIGHT, INPUT_PAUSE, INPUT_QUIT};
+    if (spec.size() < 4 || spec.size() > 6) {
+        return false;
+    }
+    for (size_t i = 0; i < spec.size(); i++) {
+        // Keys must be distinct and must not start an escape sequence
+        if (spec[i] == 0x1B || spec.find(spec[i], i + 1) != std::string::npos) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < spec.size(); i++) {
+        keys.unbind(ORDER[i]);
+    }
+    for (size_t i = 0; i < spec.size(); i++) {
+        // Overwrites whatever the key did before
+        keys.bind(static_cast<unsigned char>(spec[i]), ORDER[i]);
+    }
+    return true;
+}
+
+TerminalMode::TerminalMode() : active(false) {
+#if defined(__unix__) || defined(__APPLE__)
+    if (tcgetattr(STDIN_FILENO, &saved) == 0) {
+        struct termios raw = saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        active = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    }
+#endif
+}
+
+TerminalMode::~TerminalMode() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (active) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    }
+#endif
+}
+
+void input_handler() {
+    // Decodes its own copy of the stream, so the tail of an escape sequence
+    // is never taken for the quit key
+    KeyDecoder decoder;
+    while (true) {
+        int c = std::cin.get();
+        if (c == EOF) break;
+        char input = static_cast<char>(c);
+        if (g_game) {
+            g_game->postInput(input);
+            if (decoder.feed(g_game->getKeys(), static_cast<unsigned char>(input)) == INPUT_QUIT) return;
+        }
+    }
+}
+
+void game_play() {
+    if (!g_game) {
+        g_game = new SnakeGame();
+    }
+    g_game->startGame();
+    while (!g_game->isGameOver()) {
+        g_game->updateGame();
+    }
+}
+
+#if defined(__linux__)
+static void arm_timer(int timerFd, int64_t delayNs) {
+    // A zero timeout would disarm the timer instead of firing it at once
+    if (delayNs < 1) delayNs = 1;
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = delayNs / 1000000000LL;
+    spec.it_value.tv_nsec = delayNs % 1000000000LL;
+    timerfd_settime(timerFd, 0, &spec, nullptr);
+}
+
+int run_event_loop(SnakeGame& game) {
+    int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timerFd < 0) {
+        return -1;
+    }
+    
+    struct pollfd fds[2];
+    fds[0].fd = STDIN_FILENO;
+    fds[0].events = POLLIN;
+    fds[1].fd = timerFd;
+    fds[1].events = POLLIN;
+    
+    game.startGame();
+    // The game's tick budget keeps the absolute schedule; the timer only
+    // waits out what is left of the current interval
+    arm_timer(timerFd, 0);
+    
+    while (!game.isGameOver()) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        
+        if (fds[0].revents & (POLLIN | POLLHUP)) {
+            char buffer[64];
+            ssize_t count = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (count <= 0) {
+                fds[0].fd = -1; // stdin closed: keep ticking without input
+            }
+            for (ssize_t i = 0; i < count; i++) {
+                game.postInput(buffer[i]);
+            }
+            // Pause and quit take effect now; turns wait for the next tick
+            game.drainInput();
+        }
+        
+        if (fds[1].revents & POLLIN) {
+            uint64_t expirations;
+            if (read(timerFd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+                break;
+            }
+            game.tick();
+            arm_timer(timerFd, game.tickSleepNs());
+        }
+    }
+    
+    close(timerFd);
+    return 0;
+}
+#endif
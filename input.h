@@ -0,0 +1,90 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <cstdint>
+#include <string>
+#if defined(__unix__) || defined(__APPLE__)
+#include <termios.h>
+#endif
+#include "engine.h"
+
+const char PAUSE_KEY = 'x';
+const char QUIT_KEY = 'q';
+
+// What a key does. The four directions share their values with DIR_*.
+enum InputAction : uint8_t {
+    INPUT_RIGHT = DIR_RIGHT,
+    INPUT_LEFT = DIR_LEFT,
+    INPUT_UP = DIR_UP,
+    INPUT_DOWN = DIR_DOWN,
+    INPUT_PAUSE,
+    INPUT_QUIT,
+    INPUT_NONE
+};
+
+// Byte -> action lookup table. Copyable and fixed size, so rebinding keys
+// never allocates and a lookup is a single load.
+struct KeyMap {
+    uint8_t actions[256];
+
+    constexpr InputAction lookup(unsigned char key) const { return static_cast<InputAction>(actions[key]); }
+    constexpr void bind(unsigned char key, InputAction action) { actions[key] = action; }
+    // Unbind every key currently mapped to action
+    constexpr void unbind(InputAction action) {
+        for (uint8_t& a : actions) {
+            if (a == action) a = INPUT_NONE;
+        }
+    }
+};
+
+constexpr KeyMap make_default_keymap() {
+    KeyMap keys{};
+    for (uint8_t& a : keys.actions) {
+        a = INPUT_NONE;
+    }
+    keys.bind('d', INPUT_RIGHT);
+    keys.bind('a', INPUT_LEFT);
+    keys.bind('w', INPUT_UP);
+    keys.bind('s', INPUT_DOWN);
+    keys.bind(PAUSE_KEY, INPUT_PAUSE);
+    keys.bind(QUIT_KEY, INPUT_QUIT);
+    return keys;
+}
+
+constexpr KeyMap DEFAULT_KEYMAP = make_default_keymap();
+static_assert(DEFAULT_KEYMAP.lookup('w') == INPUT_UP, "default bindings are wasd");
+
+// Turns raw terminal bytes into actions. Arrow keys arrive as ESC [ A..D (or
+// ESC O A..D in application mode) and are decoded across calls, so the bytes
+// of one sequence may be split between reads.
+class KeyDecoder {
+private:
+    enum State : uint8_t { GROUND, ESCAPE, SEQUENCE };
+    State state;
+
+public:
+    KeyDecoder() : state(GROUND) {}
+    // Action for this byte, INPUT_NONE while a sequence is incomplete
+    InputAction feed(const KeyMap& keys, unsigned char byte);
+};
+
+// Rebind the movement keys from four characters in the order up, left, down,
+// right (like "wasd"), optionally followed by pause and quit keys
+bool parse_key_bindings(const std::string& spec, KeyMap& keys);
+
+// Puts the terminal into unbuffered, no-echo mode for its lifetime
+class TerminalMode {
+private:
+#if defined(__unix__) || defined(__APPLE__)
+    struct termios saved;
+#endif
+    bool active;
+    
+public:
+    TerminalMode();
+    ~TerminalMode();
+    TerminalMode(const TerminalMode&) = delete;
+    TerminalMode& operator=(const TerminalMode&) = delete;
+};
+
+#endif
@@ -1,14 +1,91 @@
 #include "snake.h"
+#include "agent.h"
 #include <thread>
+#include <cstring>
+#include <iostream>
 
-SnakeGame* g_game = nullptr;
+static void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [--width N] [--height N] [--seed N] [--record FILE] [--keys KEYS]\n"
+              << "       " << prog << " [--speed stepped|linear:MS|exp:FACTOR|table:LEN=MS,...]\n"
+              << "       " << prog << " [--agent NAME]  (" << AGENT_NAMES << ")\n"
+              << "       " << prog << " --replay FILE [--rate X]" << std::endl;
+}
+
+static std::string replay_path;
+static double replay_rate = 0;
+static std::string agent_name;
+
+static bool parse_args(int argc, char* argv[], GameConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+            config.width = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--height") == 0 && i + 1 < argc) {
+            config.height = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            config.recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--keys") == 0 && i + 1 < argc) {
+            if (!parse_key_bindings(argv[++i], config.keys)) return false;
+        } else if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            if (!parse_speed_curve(argv[++i], config.speed)) return false;
+        } else if (std::strcmp(argv[i], "--agent") == 0 && i + 1 < argc) {
+            agent_name = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            replay_rate = std::atof(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return config.width > 0 && config.width <= MAX_BOARD_SIDE && config.height > 0 &&
+           config.height <= MAX_BOARD_SIDE;
+}
 
 int main(int argc, char* argv[]) {
-    std::thread input_thread(input_handler);
-    std::thread game_thread(game_play);
-    input_thread.join();
-    game_thread.join();
+    SNAKE_PROFILE_INSTALL_SIGNAL();
+    GameConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (!replay_path.empty()) {
+        return replay_game(replay_path, replay_rate);
+    }
+    std::unique_ptr<Agent> agent;
+    if (!agent_name.empty()) {
+        agent = make_agent(agent_name, DynamicBoard(config.width, config.height));
+        if (!agent) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    g_game = new SnakeGame(config);
+    g_game->setAgent(std::move(agent));
+    
+    bool inputThread = false;
+    {
+        TerminalMode terminal;
+#if defined(__linux__)
+        if (run_event_loop(*g_game) != 0)
+#endif
+        {
+            // No timerfd: fall back to a blocking input thread beside the game loop.
+            // The input thread may still be blocked in a read when the game ends.
+            std::thread input_thread(input_handler);
+            input_thread.detach();
+            inputThread = true;
+            game_play();
+        }
+    }
+    // After the terminal is restored, so the table prints cleanly
+    SNAKE_PROFILE_DUMP();
+    // A detached input thread can post a key to the game until the process
+    // exits, so the game is only freed when no such thread was started
+    if (!inputThread) {
+        delete g_game;
+        g_game = nullptr;
+    }
     return 0;
 }
-
-
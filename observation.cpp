@@ -0,0 +1,116 @@
+#include "observation.h"
+
+static int wrap_index(int value, int n) {
+    value %= n;
+    return value < 0 ? value + n : value;
+}
+
+void encode_planes(const SnakeBatch& batch, float* out, int begin, int end) {
+    const int cells = batch.getWidth() * batch.getHeight();
+    if (end < 0) end = batch.size();
+    for (int k = begin; k < end; k++) {
+        float* planes = out + static_cast<size_t>(k) * PLANE_COUNT * cells;
+        float* body = planes + PLANE_BODY * cells;
+        const uint8_t* occupancy = batch.occupancy(k);
+        std::memset(planes, 0, sizeof(float) * PLANE_COUNT * cells);
+        for (int i = 0; i < cells; i++) {
+            body[i] = static_cast<float>(occupancy[i]);
+        }
+        planes[PLANE_HEAD * cells + batch.headRows()[k] * batch.getWidth() + batch.headCols()[k]] = 1.0f;
+        if (batch.foodCells()[k] >= 0) planes[PLANE_FOOD * cells + batch.foodCells()[k]] = 1.0f;
+        if (batch.poisonCells()[k] >= 0) planes[PLANE_POISON * cells + batch.poisonCells()[k]] = 1.0f;
+    }
+}
+
+void encode_body_age(const SnakeBatch& batch, float* out, int begin, int end) {
+    const int cells = batch.getWidth() * batch.getHeight();
+    if (end < 0) end = batch.size();
+    for (int k = begin; k < end; k++) {
+        float* plane = out + static_cast<size_t>(k) * cells;
+        std::memset(plane, 0, sizeof(float) * cells);
+        const int32_t* ring = batch.bodyRing(k);
+        const int length = batch.lengths()[k];
+        const int tail = batch.tailIndex(k);
+        const float step = 1.0f / static_cast<float>(length);
+        // The ring wraps at most once, so walk it as two straight runs
+        int firstRun = std::min(length, cells - tail);
+        for (int i = 0; i < firstRun; i++) {
+            plane[ring[tail + i]] = static_cast<float>(i + 1) * step;
+        }
+        for (int i = firstRun; i < length; i++) {
+            plane[ring[i - firstRun]] = static_cast<float>(i + 1) * step;
+        }
+    }
+}
+
+bool encode_crops(const SnakeBatch& batch, int radius, float* out, int begin, int end) {
+    if (radius < 0 || radius > MAX_CROP_RADIUS) {
+        return false;
+    }
+    const int w = batch.getWidth();
+    const int h = batch.getHeight();
+    const int side = 2 * radius + 1;
+    const int area = side * side;
+    if (end < 0) end = batch.size();
+    for (int k = begin; k < end; k++) {
+        float* body = out + static_cast<size_t>(k) * CROP_CHANNEL_COUNT * area;
+        float* food = body + CROP_FOOD * area;
+        float* poison = body + CROP_POISON * area;
+        const uint8_t* occupancy = batch.occupancy(k);
+        const int foodCell = batch.foodCells()[k];
+        const int poisonCell = batch.poisonCells()[k];
+        const int headRow = batch.headRows()[k];
+        const int headCol = batch.headCols()[k];
+
+        // Board offsets of crop cell (0, 0) and of one step along a crop row
+        // and down a crop column, for each heading. Moving forward is up
+        // the crop and the snake's right is right along it.
+        int rowAt, colAt, rowAlong, colAlong, rowDown, colDown;
+        switch (batch.directions()[k]) {
+            case ACTION_UP:
+                rowAt = -radius; colAt = -radius; rowAlong = 0; colAlong = 1; rowDown = 1; colDown = 0;
+                break;
+            case ACTION_DOWN:
+                rowAt = radius; colAt = radius; rowAlong = 0; colAlong = -1; rowDown = -1; colDown = 0;
+                break;
+            case ACTION_RIGHT:
+                rowAt = -radius; colAt = radius; rowAlong = 1; colAlong = 0; rowDown = 0; colDown = -1;
+                break;
+            default: // ACTION_LEFT
+                rowAt = radius; colAt = -radius; rowAlong = -1; colAlong = 0; rowDown = 0; colDown = 1;
+                break;
+        }
+
+        int lineRow = wrap_index(headRow + rowAt, h);
+        int lineCol = wrap_index(headCol + colAt, w);
+        int32_t line[2 * MAX_CROP_RADIUS + 1];
+        for (int r = 0; r < side; r++) {
+            // Board cells under this crop row, wrapping at the board edges;
+            // the three channels are then straight loops over them
+            int row = lineRow;
+            int col = lineCol;
+            for (int c = 0; c < side; c++) {
+                line[c] = row * w + col;
+                row += rowAlong;
+                col += colAlong;
+                row = row < 0 ? row + h : (row >= h ? row - h : row);
+                col = col < 0 ? col + w : (col >= w ? col - w : col);
+            }
+            float* bodyRow = body + r * side;
+            float* foodRow = food + r * side;
+            float* poisonRow = poison + r * side;
+            for (int c = 0; c < side; c++) {
+                bodyRow[c] = static_cast<float>(occupancy[line[c]]);
+            }
+            for (int c = 0; c < side; c++) {
+                foodRow[c] = line[c] == foodCell ? 1.0f : 0.0f;
+                poisonRow[c] = line[c] == poisonCell ? 1.0f : 0.0f;
+            }
+            lineRow += rowDown;
+            lineCol += colDown;
+            lineRow = lineRow < 0 ? lineRow + h : (lineRow >= h ? lineRow - h : lineRow);
+            lineCol = lineCol < 0 ? lineCol + w : (lineCol >= w ? lineCol - w : lineCol);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef OBSERVATION_H
+#define OBSERVATION_H
+
+#include "snake_batch.h"
+#include <cstdint>
+#include <cstring>
+
+// Observation tensors for training, written straight from SnakeBatch's
+// arrays into caller-owned float buffers. Nothing is allocated and no
+// (row, column) pairs are built; the per-cell work is plain loops over
+// contiguous memory that the compiler vectorizes, so buffers aligned to
+// OBSERVATION_ALIGNMENT bytes encode fastest. Every encoder takes a game
+// range [begin, end) so a batch can be split across threads; out always
+// points at game 0 of the full tensor.
+const size_t OBSERVATION_ALIGNMENT = 64;
+
+// One-hot planes, tensor shape [games][PLANE_COUNT][height][width]. The body
+// plane covers every segment, head included.
+enum ObservationPlane {
+    PLANE_HEAD,
+    PLANE_BODY,
+    PLANE_FOOD,
+    PLANE_POISON,
+    PLANE_COUNT
+};
+
+// Channels of an egocentric crop: [games][CROP_CHANNEL_COUNT][2r + 1][2r + 1]
+enum CropChannel {
+    CROP_BODY,
+    CROP_FOOD,
+    CROP_POISON,
+    CROP_CHANNEL_COUNT
+};
+
+inline size_t planes_size(const SnakeBatch& batch) {
+    return static_cast<size_t>(batch.size()) * PLANE_COUNT * batch.getWidth() * batch.getHeight();
+}
+
+// Body-age tensor, shape [games][height][width]
+inline size_t body_age_size(const SnakeBatch& batch) {
+    return static_cast<size_t>(batch.size()) * batch.getWidth() * batch.getHeight();
+}
+
+// Largest crop radius encode_crops accepts
+const int MAX_CROP_RADIUS = 64;
+
+inline size_t crop_size(const SnakeBatch& batch, int radius) {
+    size_t side = 2 * static_cast<size_t>(radius) + 1;
+    return static_cast<size_t>(batch.size()) * CROP_CHANNEL_COUNT * side * side;
+}
+
+void encode_planes(const SnakeBatch& batch, float* out, int begin = 0, int end = -1);
+// Each body cell holds (i + 1) / length, where i counts segments from the
+// tail: the head is 1 and the smaller the value, the sooner the cell frees
+// up. Empty cells are 0.
+void encode_body_age(const SnakeBatch& batch, float* out, int begin = 0, int end = -1);
+// Window of (2 * radius + 1)^2 cells centred on the head, wrapping around
+// the board edges and turned so the snake always faces the top row: the
+// row above the centre is the cell straight ahead, the column to its right
+// is the snake's right-hand side. Returns false and writes nothing unless
+// 0 <= radius <= MAX_CROP_RADIUS.
+bool encode_crops(const SnakeBatch& batch, int radius, float* out, int begin = 0, int end = -1);
+
+#endif
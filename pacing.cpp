@@ -0,0 +1,152 @@
+#include "pacing.h"
+#include "profile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// SpeedCurve class implementation
+SpeedCurve SpeedCurve::linear(double msPerSegment, int baseMs, int floorMs) {
+    SpeedCurve curve;
+    curve.kind = SPEED_LINEAR;
+    curve.baseMs = baseMs;
+    curve.floorMs = floorMs;
+    curve.slope = msPerSegment;
+    return curve;
+}
+
+SpeedCurve SpeedCurve::exponential(double factor, int baseMs, int floorMs) {
+    SpeedCurve curve;
+    curve.kind = SPEED_EXPONENTIAL;
+    curve.baseMs = baseMs;
+    curve.floorMs = floorMs;
+    curve.factor = factor;
+    return curve;
+}
+
+SpeedCurve SpeedCurve::table(std::vector<std::pair<int, int>> points, int floorMs) {
+    SpeedCurve curve;
+    curve.kind = SPEED_TABLE;
+    curve.floorMs = floorMs;
+    curve.points = std::move(points);
+    return curve;
+}
+
+int SpeedCurve::delayMs(size_t length) const {
+    const double segments = length > 0 ? static_cast<double>(length - 1) : 0.0;
+    double ms;
+    switch (kind) {
+        case SPEED_LINEAR:
+            ms = baseMs - slope * segments;
+            break;
+        case SPEED_EXPONENTIAL:
+            ms = floorMs + (baseMs - floorMs) * std::pow(factor, segments);
+            break;
+        case SPEED_TABLE: {
+            const int n = static_cast<int>(length);
+            if (n <= points.front().first) {
+                ms = points.front().second;
+                break;
+            }
+            if (n >= points.back().first) {
+                ms = points.back().second;
+                break;
+            }
+            // First point past n; n lies between it and the one before
+            auto next = std::upper_bound(points.begin(), points.end(), n,
+                                         [](int len, const std::pair<int, int>& p) { return len < p.first; });
+            auto prev = next - 1;
+            double t = static_cast<double>(n - prev->first) / (next->first - prev->first);
+            ms = prev->second + t * (next->second - prev->second);
+            break;
+        }
+        default: {
+            int reduction = static_cast<int>(length / 10) * DELAY_REDUCTION_MS;
+            ms = baseMs - reduction;
+            break;
+        }
+    }
+    return std::max(floorMs, static_cast<int>(std::lround(ms)));
+}
+
+bool parse_speed_curve(const std::string& spec, SpeedCurve& curve) {
+    if (spec == "stepped") {
+        curve = SpeedCurve::stepped();
+        return true;
+    }
+    size_t colon = spec.find(':');
+    if (colon == std::string::npos || colon + 1 == spec.size()) {
+        return false;
+    }
+    const std::string kind = spec.substr(0, colon);
+    const char* arg = spec.c_str() + colon + 1;
+    char* end = nullptr;
+    if (kind == "linear") {
+        double slope = std::strtod(arg, &end);
+        if (*end != '\0' || !(slope >= 0)) return false;
+        curve = SpeedCurve::linear(slope);
+        return true;
+    }
+    if (kind == "exp") {
+        double factor = std::strtod(arg, &end);
+        if (*end != '\0' || !(factor > 0 && factor <= 1)) return false;
+        curve = SpeedCurve::exponential(factor);
+        return true;
+    }
+    if (kind != "table") {
+        return false;
+    }
+    std::vector<std::pair<int, int>> points;
+    while (true) {
+        long length = std::strtol(arg, &end, 10);
+        if (end == arg || *end != '=') return false;
+        arg = end + 1;
+        long ms = std::strtol(arg, &end, 10);
+        if (end == arg || length < 1 || ms < 1) return false;
+        if (!points.empty() && length <= points.back().first) return false;
+        points.emplace_back(static_cast<int>(length), static_cast<int>(ms));
+        if (*end == '\0') break;
+        if (*end != ',') return false;
+        arg = end + 1;
+    }
+    curve = SpeedCurve::table(std::move(points));
+    return true;
+}
+
+// TickBudget class implementation
+void TickBudget::beginTick(int64_t nowNs) {
+    if (!started) {
+        deadline = nowNs;
+        started = true;
+    }
+    SNAKE_PROFILE_RECORD(PROFILE_JITTER, nowNs - deadline);
+    tickStart = nowNs;
+}
+
+int64_t TickBudget::endTick(int64_t nowNs, int64_t intervalNs) {
+    stats.ticks++;
+    if (skipRender) {
+        stats.skippedFrames++;
+    }
+    stats.lastWorkNs = nowNs - tickStart;
+    stats.maxWorkNs = std::max(stats.maxWorkNs, stats.lastWorkNs);
+
+    deadline += intervalNs;
+    if (nowNs <= deadline) {
+        skipRender = false;
+        skipRun = 0;
+        return deadline;
+    }
+    stats.missedDeadlines++;
+    if (skipRun < MAX_FRAME_SKIP) {
+        // Run the next tick at once and leave drawing it out
+        skipRender = true;
+        skipRun++;
+    } else {
+        // Too far behind to catch up: draw again and start the schedule over
+        deadline = nowNs;
+        skipRender = false;
+        skipRun = 0;
+        stats.resyncs++;
+    }
+    return deadline;
+}
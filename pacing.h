@@ -0,0 +1,97 @@
+#ifndef PACING_H
+#define PACING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+const int BASE_DELAY_MS = 500;
+const int MIN_DELAY_MS = 100;
+const int DELAY_REDUCTION_MS = 50;
+const int PAUSED_DELAY_MS = 200;
+
+// Longest run of ticks simulated without drawing while catching up
+const int MAX_FRAME_SKIP = 4;
+
+// How the tick interval shrinks as the snake grows
+enum SpeedCurveKind {
+    SPEED_STEPPED,     // DELAY_REDUCTION_MS faster every 10 segments (the classic curve)
+    SPEED_LINEAR,      // slope ms faster per segment
+    SPEED_EXPONENTIAL, // the gap above the floor shrinks by factor per segment
+    SPEED_TABLE        // linear interpolation between (length, delay) points
+};
+
+// Tick interval as a function of snake length, never below floorMs. Every
+// kind starts from baseMs at length 1 except tables, which give their own
+// delays and are only clamped to the floor.
+class SpeedCurve {
+private:
+    SpeedCurveKind kind;
+    int baseMs;
+    int floorMs;
+    double slope;  // ms per segment (linear)
+    double factor; // per-segment decay of the gap above the floor (exponential)
+    std::vector<std::pair<int, int>> points; // (length, ms), lengths increasing (table)
+
+public:
+    SpeedCurve() : kind(SPEED_STEPPED), baseMs(BASE_DELAY_MS), floorMs(MIN_DELAY_MS), slope(0), factor(1) {}
+
+    static SpeedCurve stepped() { return SpeedCurve(); }
+    static SpeedCurve linear(double msPerSegment, int baseMs = BASE_DELAY_MS, int floorMs = MIN_DELAY_MS);
+    static SpeedCurve exponential(double factor, int baseMs = BASE_DELAY_MS, int floorMs = MIN_DELAY_MS);
+    // points must be non-empty with strictly increasing lengths
+    static SpeedCurve table(std::vector<std::pair<int, int>> points, int floorMs = MIN_DELAY_MS);
+
+    int delayMs(size_t length) const;
+    SpeedCurveKind getKind() const { return kind; }
+};
+
+// Parse a --speed argument: "stepped", "linear:MS" (ms per segment),
+// "exp:FACTOR" (0 < FACTOR <= 1) or "table:LEN=MS,LEN=MS,..." with
+// increasing lengths. Returns false and leaves curve untouched on bad input.
+bool parse_speed_curve(const std::string& spec, SpeedCurve& curve);
+
+// What the controller saw since the game started
+struct TickBudgetStats {
+    int64_t ticks = 0;
+    int64_t missedDeadlines = 0; // ticks whose work ran past the next deadline
+    int64_t skippedFrames = 0;   // ticks simulated without drawing to catch up
+    int64_t resyncs = 0;         // times the controller gave up catching up
+    int64_t lastWorkNs = 0;      // simulation plus render time of the last tick
+    int64_t maxWorkNs = 0;
+};
+
+// Holds the game to its tick rate. Each tick runs at an absolute deadline
+// and the next deadline is one interval later, so simulation and render time
+// come out of the interval instead of being added to it. When a tick's work
+// overruns the next deadline the following ticks skip drawing until the game
+// is back on schedule; after MAX_FRAME_SKIP such ticks the schedule is reset
+// to now instead. The caller supplies the clock, in nanoseconds.
+class TickBudget {
+private:
+    int64_t deadline;  // when the current (or next) tick is due
+    int64_t tickStart;
+    bool started;
+    bool skipRender;
+    int skipRun;
+    TickBudgetStats stats;
+
+public:
+    TickBudget() : deadline(0), tickStart(0), started(false), skipRender(false), skipRun(0) {}
+
+    // Mark the start of a tick's work; the first call starts the schedule
+    void beginTick(int64_t nowNs);
+    // Mark the end of the tick's work and schedule the next one intervalNs
+    // after this one's deadline. Returns the absolute time it is due.
+    int64_t endTick(int64_t nowNs, int64_t intervalNs);
+    // Nanoseconds to wait before the next tick, 0 when it is already due
+    int64_t sleepNs(int64_t nowNs) const { return deadline > nowNs ? deadline - nowNs : 0; }
+    // False while catching up: simulate the tick but do not draw it
+    bool shouldRender() const { return !skipRender; }
+    int64_t nextDeadline() const { return deadline; }
+    const TickBudgetStats& getStats() const { return stats; }
+};
+
+#endif
@@ -0,0 +1,130 @@
+#include "profile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// LatencyHistogram class implementation
+int LatencyHistogram::bucketOf(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+    // The top SUB_BITS + 1 bits pick the bucket: the leading one selects the
+    // power of two, the bits after it the slice
+#if defined(__GNUC__)
+    int msb = 63 - __builtin_clzll(value);
+#else
+    int msb = SUB_BITS;
+    while (value >> (msb + 1)) msb++;
+#endif
+    int shift = msb - SUB_BITS;
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::bucketLimit(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint64_t slice = static_cast<uint64_t>(bucket % SUB_BUCKETS) | SUB_BUCKETS;
+    return ((slice + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(int64_t ns) {
+    uint64_t value = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t seen = maximum.load(std::memory_order_relaxed);
+    while (value > seen && !maximum.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::clear() {
+    for (std::atomic<uint64_t>& count : counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    return n == 0 ? 0.0 : static_cast<double>(sum.load(std::memory_order_relaxed)) / n;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(fraction * n);
+    if (target >= n) target = n - 1;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += counts[bucket].load(std::memory_order_relaxed);
+        if (seen > target) {
+            return std::min(bucketLimit(bucket), max());
+        }
+    }
+    return max();
+}
+
+// Profiler class implementation
+void Profiler::clear() {
+    for (LatencyHistogram& histogram : histograms) {
+        histogram.clear();
+    }
+}
+
+void Profiler::writeText(std::ostream& out) const {
+    out << "=== Profile (microseconds) ===\n";
+    out << "phase              count       p50       p90       p99     p99.9       max      mean\n";
+    char line[160];
+    for (int i = 0; i < PROFILE_PHASES; i++) {
+        const LatencyHistogram& h = histograms[i];
+        if (h.count() == 0) continue;
+        std::snprintf(line, sizeof(line), "%-14s %9llu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", PROFILE_PHASE_NAMES[i],
+                      static_cast<unsigned long long>(h.count()), h.percentile(0.50) / 1e3, h.percentile(0.90) / 1e3,
+                      h.percentile(0.99) / 1e3, h.percentile(0.999) / 1e3, h.max() / 1e3, h.mean() / 1e3);
+        out << line;
+    }
+    out.flush();
+}
+
+void Profiler::writeJson(std::ostream& out) const {
+    out << "{\"unit\": \"ns\", \"phases\": {";
+    bool first = true;
+    for (int i = 0; i < PROFILE_PHASES; i++) {
+        const LatencyHistogram& h = histograms[i];
+        if (h.count() == 0) continue;
+        out << (first ? "" : ", ") << "\"" << PROFILE_PHASE_NAMES[i] << "\": {"
+            << "\"count\": " << h.count() << ", \"p50\": " << h.percentile(0.50) << ", \"p90\": " << h.percentile(0.90)
+            << ", \"p99\": " << h.percentile(0.99) << ", \"p999\": " << h.percentile(0.999) << ", \"max\": " << h.max()
+            << ", \"mean\": " << static_cast<uint64_t>(h.mean()) << "}";
+        first = false;
+    }
+    out << "}}\n";
+    out.flush();
+}
+
+bool Profiler::dump() const {
+    const char* path = std::getenv("SNAKE_PROFILE_OUT");
+    if (!path || !*path) {
+        writeText(std::cerr);
+        return true;
+    }
+    std::string name(path);
+    std::ofstream out(name, std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Warning: Could not write profile to " << name << std::endl;
+        return true;
+    }
+    bool json = name.size() >= 5 && name.compare(name.size() - 5, 5, ".json") == 0;
+    if (json) {
+        writeJson(out);
+    } else {
+        writeText(out);
+    }
+    return false;
+}
@@ -0,0 +1,143 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <iosfwd>
+
+// Timing histograms for the game's hot paths. Building with SNAKE_PROFILE
+// defined (cmake -DSNAKE_PROFILE=ON) turns the SNAKE_PROFILE_* macros into
+// clock reads and histogram updates; without it they compile to nothing.
+enum ProfilePhase {
+    PROFILE_TICK,          // one whole SnakeGame::tick
+    PROFILE_INPUT,         // draining queued keys
+    PROFILE_AGENT,         // autopilot choosing a move
+    PROFILE_STEP,          // engine step, food placement included
+    PROFILE_FOOD,          // placing food and poison
+    PROFILE_RENDER,        // building the frame
+    PROFILE_PRESENT,       // writing the frame to the terminal
+    PROFILE_SLEEP,         // time asleep between ticks
+    PROFILE_JITTER,        // how late the tick started after its deadline
+    PROFILE_INPUT_LATENCY, // key press to the tick that applied it
+    PROFILE_PHASES
+};
+
+static const char* const PROFILE_PHASE_NAMES[PROFILE_PHASES] = {
+    "tick", "input", "agent", "step", "food", "render", "present", "sleep", "jitter", "input_latency"};
+
+// Log-linear histogram of nanosecond values in the style of HdrHistogram:
+// each power of two is split into SUB_BUCKETS equal slices, so any value is
+// reported within 1/SUB_BUCKETS of its true size. Recording is a handful of
+// relaxed atomic adds, safe from any thread without locks.
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+    static const int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+private:
+    std::atomic<uint64_t> counts[BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> maximum;
+
+    static int bucketOf(uint64_t value);
+    // Largest value that falls in bucket
+    static uint64_t bucketLimit(int bucket);
+
+public:
+    LatencyHistogram() { clear(); }
+
+    void record(int64_t ns);
+    void clear();
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maximum.load(std::memory_order_relaxed); }
+    double mean() const;
+    // Smallest bucket limit with at least fraction of the values at or below it
+    uint64_t percentile(double fraction) const;
+};
+
+// One histogram per phase, shared by the whole process
+class Profiler {
+private:
+    LatencyHistogram histograms[PROFILE_PHASES];
+
+public:
+    void record(ProfilePhase phase, int64_t ns) { histograms[phase].record(ns); }
+    const LatencyHistogram& histogram(ProfilePhase phase) const { return histograms[phase]; }
+    void clear();
+
+    // count, p50, p90, p99, p99.9, max and mean per phase that saw any values
+    void writeText(std::ostream& out) const;
+    void writeJson(std::ostream& out) const;
+    // Write to the file named by SNAKE_PROFILE_OUT (JSON if it ends in
+    // .json), or as text to stderr when it is not set. Returns true if
+    // anything went to stderr.
+    bool dump() const;
+};
+
+inline Profiler& profiler() {
+    static Profiler instance;
+    return instance;
+}
+
+inline int64_t profile_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Records the time from construction to destruction under phase
+class ProfileScope {
+private:
+    ProfilePhase phase;
+    int64_t start;
+
+public:
+    explicit ProfileScope(ProfilePhase phase) : phase(phase), start(profile_now_ns()) {}
+    ~ProfileScope() { profiler().record(phase, profile_now_ns() - start); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+// Set from a signal handler; the game thread dumps at its next tick
+inline std::atomic<bool>& profile_dump_requested() {
+    static std::atomic<bool> requested(false);
+    return requested;
+}
+
+inline void profile_signal_handler(int) {
+    profile_dump_requested().store(true, std::memory_order_relaxed);
+}
+
+// Dump if a signal asked for it since the last call. Returns true if the
+// dump wrote to the terminal, which the caller then has to redraw.
+inline bool profile_poll() {
+    if (profile_dump_requested().exchange(false, std::memory_order_relaxed)) {
+        return profiler().dump();
+    }
+    return false;
+}
+
+#if defined(SNAKE_PROFILE)
+#define SNAKE_PROFILE_CONCAT2(a, b) a##b
+#define SNAKE_PROFILE_CONCAT(a, b) SNAKE_PROFILE_CONCAT2(a, b)
+#define SNAKE_PROFILE_SCOPE(phase) ProfileScope SNAKE_PROFILE_CONCAT(profileScope, __LINE__)(phase)
+#define SNAKE_PROFILE_RECORD(phase, ns) profiler().record(phase, ns)
+#define SNAKE_PROFILE_POLL() profile_poll()
+#define SNAKE_PROFILE_DUMP() profiler().dump()
+#if defined(SIGUSR1)
+#define SNAKE_PROFILE_INSTALL_SIGNAL() std::signal(SIGUSR1, profile_signal_handler)
+#else
+#define SNAKE_PROFILE_INSTALL_SIGNAL() ((void)0)
+#endif
+#else
+#define SNAKE_PROFILE_SCOPE(phase) ((void)0)
+#define SNAKE_PROFILE_RECORD(phase, ns) ((void)0)
+#define SNAKE_PROFILE_POLL() false
+#define SNAKE_PROFILE_DUMP() ((void)0)
+#define SNAKE_PROFILE_INSTALL_SIGNAL() ((void)0)
+#endif
+
+#endif
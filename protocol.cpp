@@ -0,0 +1,103 @@
+#include "protocol.h"
+
+static uint64_t read_le(const unsigned char* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+void encode_welcome(std::string& out, const Arena& arena, int snake) {
+    FrameWriter frame(out);
+    frame.begin(MSG_WELCOME);
+    frame.u32(static_cast<uint32_t>(arena.getBoard().width()));
+    frame.u32(static_cast<uint32_t>(arena.getBoard().height()));
+    frame.u32(static_cast<uint32_t>(arena.size()));
+    frame.i32(snake);
+    frame.end();
+}
+
+void encode_snapshot(std::string& out, const Arena& arena) {
+    FrameWriter frame(out);
+    frame.begin(MSG_SNAPSHOT);
+    frame.u64(static_cast<uint64_t>(arena.tickCount()));
+    size_t countAt = frame.size();
+    frame.u32(0);
+    uint32_t count = 0;
+    for (int cell = 0; cell < arena.getBoard().cells(); cell++) {
+        int32_t value = arena.hasFood(cell) ? ARENA_FOOD : arena.ownerAt(cell);
+        if (value != ARENA_EMPTY) {
+            frame.u32(static_cast<uint32_t>(cell));
+            frame.i32(value);
+            count++;
+        }
+    }
+    frame.patchU32(countAt, count);
+    frame.end();
+}
+
+void encode_delta(std::string& out, const Arena& arena) {
+    FrameWriter frame(out);
+    frame.begin(MSG_DELTA);
+    frame.u64(static_cast<uint64_t>(arena.tickCount()));
+    size_t countAt = frame.size();
+    frame.u32(0);
+    uint32_t count = 0;
+    arena.forEachChange([&](const ArenaChange& change) {
+        frame.u32(static_cast<uint32_t>(change.cell));
+        frame.i32(change.value);
+        count++;
+    });
+    frame.patchU32(countAt, count);
+    frame.end();
+}
+
+// ArenaMirror class implementation
+bool ArenaMirror::feed(const char* data, size_t size) {
+    pending.append(data, size);
+    size_t pos = 0;
+    bool ok = true;
+    while (pending.size() - pos >= FRAME_HEADER_SIZE) {
+        const unsigned char* header = reinterpret_cast<const unsigned char*>(pending.data() + pos);
+        size_t length = static_cast<size_t>(read_le(header + 1, 4));
+        if (pending.size() - pos - FRAME_HEADER_SIZE < length) break;
+        if (!applyFrame(header[0], header + FRAME_HEADER_SIZE, length)) {
+            ok = false;
+        }
+        pos += FRAME_HEADER_SIZE + length;
+    }
+    pending.erase(0, pos);
+    return ok;
+}
+
+bool ArenaMirror::applyFrame(uint8_t type, const unsigned char* payload, size_t length) {
+    if (type == MSG_WELCOME) {
+        if (length != 16) return false;
+        w = static_cast<int>(read_le(payload, 4));
+        h = static_cast<int>(read_le(payload + 4, 4));
+        snakes = static_cast<int>(read_le(payload + 8, 4));
+        you = static_cast<int32_t>(read_le(payload + 12, 4));
+        if (cells.size() != static_cast<size_t>(w) * h) {
+            cells.assign(static_cast<size_t>(w) * h, ARENA_EMPTY);
+        }
+        return true;
+    }
+    if (type != MSG_SNAPSHOT && type != MSG_DELTA) {
+        return true; // unknown frames are skipped for forward compatibility
+    }
+    if (length < 12) return false;
+    uint32_t count = static_cast<uint32_t>(read_le(payload + 8, 4));
+    if (length != 12 + static_cast<size_t>(count) * CELL_ENTRY_SIZE) return false;
+    tick = read_le(payload, 8);
+    if (type == MSG_SNAPSHOT) {
+        std::fill(cells.begin(), cells.end(), ARENA_EMPTY);
+    }
+    const unsigned char* entry = payload + 12;
+    for (uint32_t i = 0; i < count; i++, entry += CELL_ENTRY_SIZE) {
+        uint32_t cell = static_cast<uint32_t>(read_le(entry, 4));
+        if (cell >= cells.size()) return false;
+        cells[cell] = static_cast<int32_t>(read_le(entry + 4, 4));
+    }
+    return true;
+}
@@ -0,0 +1,109 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "arena.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Wire protocol between snake_server and its clients. All integers are
+// little-endian.
+//
+// Client to server: single-byte commands.
+//   0x00-0x03  steer the client's snake (right, left, up, down)
+//   'J'        take control of a free snake
+//   'L'        give the snake back to the bots and keep watching
+//
+// Server to client: frames of a 1-byte type, a 4-byte payload length and
+// the payload.
+//   MSG_WELCOME   u32 width, u32 height, u32 snakes, i32 your snake (-1 when watching)
+//   MSG_SNAPSHOT  u64 tick, u32 count, count x (u32 cell, i32 value): every
+//                 non-empty cell; sent on connect and after a client fell behind
+//   MSG_DELTA     u64 tick, u32 count, count x (u32 cell, i32 value): cells the
+//                 tick changed, to be applied in order
+// Cell values are a snake id, ARENA_EMPTY or ARENA_FOOD.
+enum MessageType : uint8_t {
+    MSG_WELCOME = 1,
+    MSG_SNAPSHOT = 2,
+    MSG_DELTA = 3
+};
+
+const uint8_t CMD_JOIN = 'J';
+const uint8_t CMD_LEAVE = 'L';
+const size_t FRAME_HEADER_SIZE = 5;
+const size_t CELL_ENTRY_SIZE = 8;
+
+// Appends frames to a byte buffer
+class FrameWriter {
+private:
+    std::string& out;
+    size_t start;
+
+    void put(uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+
+public:
+    explicit FrameWriter(std::string& out) : out(out), start(0) {}
+
+    // Start a frame; the length is filled in by end()
+    void begin(MessageType type) {
+        start = out.size();
+        out.push_back(static_cast<char>(type));
+        put(0, 4);
+    }
+    void end() {
+        uint32_t length = static_cast<uint32_t>(out.size() - start - FRAME_HEADER_SIZE);
+        for (int i = 0; i < 4; i++) {
+            out[start + 1 + i] = static_cast<char>(length >> (8 * i));
+        }
+    }
+    void u32(uint32_t value) { put(value, 4); }
+    void i32(int32_t value) { put(static_cast<uint32_t>(value), 4); }
+    void u64(uint64_t value) { put(value, 8); }
+    // Overwrite a u32 written earlier at byte offset
+    void patchU32(size_t offset, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out[offset + i] = static_cast<char>(value >> (8 * i));
+        }
+    }
+    size_t size() const { return out.size(); }
+};
+
+void encode_welcome(std::string& out, const Arena& arena, int snake);
+void encode_snapshot(std::string& out, const Arena& arena);
+// Delta for the arena's last tick; needs recordChanges(true)
+void encode_delta(std::string& out, const Arena& arena);
+
+// Client-side copy of the board, rebuilt from the server's frames
+class ArenaMirror {
+private:
+    int w;
+    int h;
+    int snakes;
+    int you;
+    uint64_t tick;
+    std::vector<int32_t> cells;
+    std::string pending; // bytes of an incomplete frame
+
+    bool applyFrame(uint8_t type, const unsigned char* payload, size_t length);
+
+public:
+    ArenaMirror() : w(0), h(0), snakes(0), you(-1), tick(0) {}
+
+    // Feed bytes as they arrive; frames may be split anywhere. Returns false
+    // on a malformed frame.
+    bool feed(const char* data, size_t size);
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int snakeCount() const { return snakes; }
+    int yourSnake() const { return you; }
+    uint64_t lastTick() const { return tick; }
+    int32_t at(int cell) const { return cells[cell]; }
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include "renderer.h"
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+static const char* const GLYPHS[] = {"⬜", "🐍", "🍎", "💀"};
+
+TerminalRenderer::TerminalRenderer() : width(0), height(0), cursorRow(-1), cursorCol(-1) {}
+
+void TerminalRenderer::invalidate() {
+    std::fill(shown.begin(), shown.end(), GLYPH_NONE);
+    statusShown.clear();
+    cursorRow = -1;
+    cursorCol = -1;
+}
+
+void TerminalRenderer::moveTo(int row, int col) {
+    if (row == cursorRow && col == cursorCol) {
+        return;
+    }
+    // Rows and columns are 1-based; every glyph is two columns wide
+    frame += "\033[";
+    frame += std::to_string(row + 1);
+    frame += ';';
+    frame += std::to_string(col * 2 + 1);
+    frame += 'H';
+    cursorRow = row;
+    cursorCol = col;
+}
+
+void TerminalRenderer::appendGlyph(unsigned char glyph) {
+    frame += GLYPHS[glyph];
+    cursorCol++;
+}
+
+template const std::string& TerminalRenderer::render(const SnakeEngine& engine,
+                                                     const std::vector<std::string>& status);
+
+void TerminalRenderer::present() {
+    if (!frame.empty()) {
+        write_stdout(frame.data(), frame.size());
+        frame.clear();
+    }
+}
+
+void TerminalRenderer::clearScreen() {
+    invalidate();
+#if defined(_WIN32)
+    system("cls");
+#else
+    static const char CLEAR[] = "\033[2J\033[H";
+    write_stdout(CLEAR, sizeof(CLEAR) - 1);
+#endif
+}
+
+void write_stdout(const char* data, size_t size) {
+    // Anything still buffered in std::cout must reach the terminal first
+    std::cout.flush();
+#if defined(__unix__) || defined(__APPLE__)
+    while (size > 0) {
+        ssize_t written = write(STDOUT_FILENO, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+#else
+    std::cout.write(data, size);
+    std::cout.flush();
+#endif
+}
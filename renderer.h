@@ -0,0 +1,103 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <string>
+#include <vector>
+#include "engine.h"
+
+// Terminal renderer that keeps a copy of what is on screen and, each frame,
+// rewrites only the cells that differ using ANSI cursor addressing. The
+// whole frame is assembled in one reused buffer and sent with a single write.
+class TerminalRenderer {
+public:
+    enum Glyph : unsigned char { GLYPH_EMPTY, GLYPH_SNAKE, GLYPH_FOOD, GLYPH_POISON, GLYPH_NONE };
+    
+private:
+    std::string frame;                // output buffer, reused across frames
+    std::vector<unsigned char> shown; // glyph currently on screen for each cell
+    std::vector<std::string> statusShown;
+    int width;
+    int height;
+    int cursorRow;
+    int cursorCol;
+    
+    void moveTo(int row, int col);
+    void appendGlyph(unsigned char glyph);
+    
+public:
+    TerminalRenderer();
+    
+    // Forget the screen contents so the next frame is drawn in full
+    void invalidate();
+    // Build the next frame into the buffer; status lines go below the board
+    template <typename Engine>
+    const std::string& render(const Engine& engine, const std::vector<std::string>& status);
+    // Send the buffered frame to stdout
+    void present();
+    // Clear the terminal and forget its contents
+    void clearScreen();
+    
+    const std::string& getFrame() const { return frame; }
+};
+
+// Write all of data to stdout, retrying short writes
+void write_stdout(const char* data, size_t size);
+
+
+// TerminalRenderer class implementation
+template <typename Engine>
+const std::string& TerminalRenderer::render(const Engine& engine, const std::vector<std::string>& status) {
+    const auto& board = engine.getBoard();
+    if (board.width() != width || board.height() != height) {
+        width = board.width();
+        height = board.height();
+        shown.assign(board.cells(), GLYPH_NONE);
+        frame.reserve(static_cast<size_t>(board.cells()) * 16);
+        invalidate();
+    }
+    frame.clear();
+    
+    const auto food = engine.getFood();
+    const auto poisonFood = engine.getPoisonFood();
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            unsigned char glyph;
+            if (i == food.first && j == food.second) {
+                glyph = GLYPH_FOOD;
+            } else if (engine.isOccupied(std::make_pair(i, j))) {
+                glyph = GLYPH_SNAKE;
+            } else if (i == poisonFood.first && j == poisonFood.second) {
+                glyph = GLYPH_POISON;
+            } else {
+                glyph = GLYPH_EMPTY;
+            }
+            
+            unsigned char& current = shown[i * width + j];
+            if (current != glyph) {
+                moveTo(i, j);
+                appendGlyph(glyph);
+                current = glyph;
+            }
+        }
+    }
+    
+    for (size_t line = 0; line < status.size(); line++) {
+        if (line < statusShown.size() && statusShown[line] == status[line]) {
+            continue;
+        }
+        frame += "\033[";
+        frame += std::to_string(height + 1 + static_cast<int>(line));
+        frame += ";1H";
+        frame += status[line];
+        frame += "\033[K";
+        cursorRow = -1;
+    }
+    statusShown = status;
+    return frame;
+}
+
+// SnakeEngine frames are built in renderer.cpp
+extern template const std::string& TerminalRenderer::render(const SnakeEngine& engine,
+                                                            const std::vector<std::string>& status);
+
+#endif
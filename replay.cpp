@@ -0,0 +1,117 @@
+#include "replay.h"
+#include <cstring>
+#include <iterator>
+
+// Little-endian helpers
+static void put_le(unsigned char* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const unsigned char* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+// ReplayWriter class implementation
+ReplayWriter::ReplayWriter() : ticks(0), pending(0), previous(0) {}
+
+ReplayWriter::~ReplayWriter() {
+    close();
+}
+
+bool ReplayWriter::open(const std::string& path, const ReplayHeader& header) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    ticks = 0;
+    pending = 0;
+    previous = 0;
+    buffer.clear();
+    buffer.reserve(REPLAY_BUFFER_SIZE);
+
+    unsigned char raw[REPLAY_HEADER_SIZE] = {};
+    std::memcpy(raw, REPLAY_MAGIC, 4);
+    put_le(raw + 4, REPLAY_VERSION, 2);
+    put_le(raw + 8, header.seed, 8);
+    put_le(raw + 16, static_cast<uint32_t>(header.width), 4);
+    put_le(raw + 20, static_cast<uint32_t>(header.height), 4);
+    out.write(reinterpret_cast<const char*>(raw), sizeof(raw));
+    return out.good();
+}
+
+void ReplayWriter::flushBuffer() {
+    if (!buffer.empty()) {
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        buffer.clear();
+    }
+}
+
+void ReplayWriter::record(uint8_t direction) {
+    if (!out.is_open()) return;
+
+    uint8_t code = static_cast<uint8_t>((direction - previous) & 3);
+    previous = direction;
+    pending |= static_cast<unsigned char>(code << (2 * (ticks & 3)));
+    ticks++;
+    if ((ticks & 3) == 0) {
+        buffer.push_back(pending);
+        pending = 0;
+        if (buffer.size() == REPLAY_BUFFER_SIZE) {
+            flushBuffer();
+        }
+    }
+}
+
+void ReplayWriter::close() {
+    if (!out.is_open()) return;
+
+    if ((ticks & 3) != 0) {
+        buffer.push_back(pending);
+    }
+    flushBuffer();
+    unsigned char count[8];
+    put_le(count, ticks, 8);
+    out.seekp(24);
+    out.write(reinterpret_cast<const char*>(count), sizeof(count));
+    out.close();
+}
+
+// ReplayReader class implementation
+bool ReplayReader::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    unsigned char raw[REPLAY_HEADER_SIZE];
+    if (!in.read(reinterpret_cast<char*>(raw), sizeof(raw)) ||
+        std::memcmp(raw, REPLAY_MAGIC, 4) != 0 || get_le(raw + 4, 2) != REPLAY_VERSION) {
+        return false;
+    }
+    head.seed = get_le(raw + 8, 8);
+    head.width = static_cast<int32_t>(get_le(raw + 16, 4));
+    head.height = static_cast<int32_t>(get_le(raw + 20, 4));
+    head.ticks = get_le(raw + 24, 8);
+
+    body.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (head.ticks == 0 || head.ticks > body.size() * 4) {
+        head.ticks = body.size() * 4;
+    }
+    // A board bigger than the game allows is a damaged or foreign file
+    return head.width > 0 && head.width <= MAX_BOARD_SIDE && head.height > 0 && head.height <= MAX_BOARD_SIDE;
+}
+
+std::vector<uint8_t> ReplayReader::directions() const {
+    std::vector<uint8_t> dirs(head.ticks);
+    uint8_t direction = 0;
+    for (uint64_t i = 0; i < head.ticks; i++) {
+        direction = static_cast<uint8_t>((direction + (body[i >> 2] >> (2 * (i & 3)))) & 3);
+        dirs[i] = direction;
+    }
+    return dirs;
+}
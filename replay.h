@@ -0,0 +1,79 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "board_limits.h"
+
+// Binary replay format. Everything needed to re-simulate a game is the seed,
+// the board size and the direction the snake moved on each tick, so that is
+// all a replay stores. All integers are little-endian.
+//
+//   offset  size  field
+//        0     4  magic "SNKR"
+//        4     2  format version (REPLAY_VERSION)
+//        6     2  reserved, zero
+//        8     8  engine seed
+//       16     4  board width
+//       20     4  board height
+//       24     8  tick count, patched in when the writer closes; zero if the
+//                 recording was cut short, in which case every full byte counts
+//       32     -  ticks, four per byte starting at the low bits. Each 2-bit code
+//                 is (direction - previous direction) & 3 with directions numbered
+//                 right, left, up, down and the first tick relative to right, so a
+//                 snake that keeps going straight records as zero bytes.
+const char REPLAY_MAGIC[4] = {'S', 'N', 'K', 'R'};
+const uint16_t REPLAY_VERSION = 1;
+const size_t REPLAY_HEADER_SIZE = 32;
+const size_t REPLAY_BUFFER_SIZE = 4096;
+
+struct ReplayHeader {
+    uint64_t seed = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    uint64_t ticks = 0;
+};
+
+// Append-only writer: ticks are packed into a small buffer that is written
+// out whenever it fills, so recording costs no syscall per tick.
+class ReplayWriter {
+private:
+    std::ofstream out;
+    std::vector<unsigned char> buffer;
+    uint64_t ticks;
+    unsigned char pending;     // byte being filled
+    uint8_t previous;          // direction of the last recorded tick
+
+    void flushBuffer();
+
+public:
+    ReplayWriter();
+    ~ReplayWriter();
+
+    bool open(const std::string& path, const ReplayHeader& header);
+    bool isOpen() const { return out.is_open(); }
+    // Record the direction (0 right, 1 left, 2 up, 3 down) used for one tick
+    void record(uint8_t direction);
+    // Flush remaining ticks and patch the tick count into the header
+    void close();
+    uint64_t tickCount() const { return ticks; }
+};
+
+// Loads a whole replay into memory and decodes directions on demand
+class ReplayReader {
+private:
+    ReplayHeader head;
+    std::vector<unsigned char> body;
+
+public:
+    bool load(const std::string& path);
+
+    const ReplayHeader& header() const { return head; }
+    uint64_t tickCount() const { return head.ticks; }
+    // Direction codes for every tick, in order
+    std::vector<uint8_t> directions() const;
+};
+
+#endif
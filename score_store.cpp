@@ -0,0 +1,134 @@
+#include "score_store.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+// TopScores class implementation
+bool TopScores::insert(int score) {
+    if (capacity == 0) return false;
+    if (heap.size() < capacity) {
+        heap.push_back(score);
+        std::push_heap(heap.begin(), heap.end(), std::greater<int>());
+        return true;
+    }
+    if (score <= heap.front()) {
+        return false;
+    }
+    std::pop_heap(heap.begin(), heap.end(), std::greater<int>());
+    heap.back() = score;
+    std::push_heap(heap.begin(), heap.end(), std::greater<int>());
+    return true;
+}
+
+std::vector<int> TopScores::sorted() const {
+    std::vector<int> out(heap);
+    std::sort(out.begin(), out.end(), std::greater<int>());
+    return out;
+}
+
+// ScoreFileLock class implementation
+ScoreFileLock::ScoreFileLock(const std::string& path) : fd(-1) {
+#if defined(__unix__) || defined(__APPLE__)
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        while (::flock(fd, LOCK_EX) != 0 && errno == EINTR) {}
+    }
+#endif
+}
+
+ScoreFileLock::~ScoreFileLock() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (fd >= 0) {
+        ::flock(fd, LOCK_UN);
+        ::close(fd);
+    }
+#endif
+}
+
+// ScoreStore class implementation
+ScoreStore::ScoreStore(const std::string& path, size_t capacity) : path(path), scores(capacity) {}
+
+void ScoreStore::readFile(TopScores& into) const {
+    std::ifstream infile(path);
+    int score;
+    while (infile >> score) {
+        if (score >= 0) { // Only accept non-negative scores
+            into.insert(score);
+        }
+    }
+}
+
+bool ScoreStore::writeFile(const TopScores& from) const {
+    // The lock serializes writers, so one temp name per file is enough
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream outfile(temp, std::ios::trunc);
+        if (!outfile.is_open()) {
+            return false;
+        }
+        for (int score : from.sorted()) {
+            outfile << score << "\n";
+        }
+        outfile.flush();
+        if (!outfile.good()) {
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    // Make the data durable before the rename makes it visible
+    int fd = ::open(temp.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#else
+    std::remove(path.c_str()); // rename does not replace an existing file here
+#endif
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void ScoreStore::load() {
+    ScoreFileLock lock(path + ".lock");
+    scores.clear();
+    readFile(scores);
+    for (int score : pending) {
+        scores.insert(score);
+    }
+}
+
+void ScoreStore::add(int score) {
+    if (score < 0) return;
+    pending.push_back(score);
+    scores.insert(score);
+}
+
+bool ScoreStore::commit() {
+    if (pending.empty()) {
+        return true;
+    }
+    ScoreFileLock lock(path + ".lock");
+    // Start from what is on disk now: other instances may have committed since we loaded
+    TopScores merged(scores.limit());
+    readFile(merged);
+    for (int score : pending) {
+        merged.insert(score);
+    }
+    if (!writeFile(merged)) {
+        return false;
+    }
+    pending.clear();
+    scores = merged;
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef SCORE_STORE_H
+#define SCORE_STORE_H
+
+#include <string>
+#include <vector>
+
+// The best K scores seen, kept as a min-heap so the weakest entry is always
+// at the front: inserting is O(log K) and memory never grows past K.
+class TopScores {
+private:
+    size_t capacity;
+    std::vector<int> heap; // min-heap on std::greater
+
+public:
+    explicit TopScores(size_t capacity) : capacity(capacity) { heap.reserve(capacity); }
+
+    // Returns false if the score is not good enough to be kept
+    bool insert(int score);
+    void clear() { heap.clear(); }
+    size_t size() const { return heap.size(); }
+    bool empty() const { return heap.empty(); }
+    size_t limit() const { return capacity; }
+    // Kept scores, best first
+    std::vector<int> sorted() const;
+};
+
+// High-score file shared by every instance on the machine. Scores from this
+// session are held back until commit(), which merges them into whatever is
+// on disk at that moment. The merge runs under an exclusive flock on a
+// sidecar lock file, so concurrent players never overwrite each other, and
+// the new contents go to a temp file that is renamed over the old one, so a
+// crash mid-write leaves the previous file intact.
+class ScoreStore {
+private:
+    std::string path;
+    TopScores scores;           // on-disk scores as of the last load or commit, plus pending
+    std::vector<int> pending;   // this session's scores not yet committed
+
+    void readFile(TopScores& into) const;
+    bool writeFile(const TopScores& from) const;
+
+public:
+    ScoreStore(const std::string& path, size_t capacity);
+
+    // Replace the in-memory view with the file's contents
+    void load();
+    // Record a score; it is written out by the next commit()
+    void add(int score);
+    // Merge pending scores into the file; does nothing when none are pending
+    bool commit();
+
+    bool hasPending() const { return !pending.empty(); }
+    const std::string& getPath() const { return path; }
+    std::vector<int> top() const { return scores.sorted(); }
+};
+
+// Exclusive advisory lock held for the lifetime of the object
+class ScoreFileLock {
+private:
+    int fd;
+
+public:
+    explicit ScoreFileLock(const std::string& path);
+    ~ScoreFileLock();
+    ScoreFileLock(const ScoreFileLock&) = delete;
+    ScoreFileLock& operator=(const ScoreFileLock&) = delete;
+};
+
+#endif
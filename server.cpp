@@ -0,0 +1,454 @@
+#include "engine.h"
+#include "arena.h"
+#include "protocol.h"
+#include "thread_pool.h"
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+struct ServerConfig {
+    std::string socketPath = "/tmp/snake.sock";
+    int width = 128;
+    int height = 128;
+    int snakes = 64;
+    int food = 0;           // 0 picks two per snake
+    int tickMs = 100;
+    uint64_t seed = 1;
+    unsigned threads = 1;
+    size_t maxBacklog = 1 << 20; // unsent bytes before a client is resynced with a snapshot
+};
+
+// One connection. Frames not yet accepted by the socket wait in out;
+// out always starts on a frame boundary.
+struct Client {
+    int fd = -1;
+    int snake = -1;        // controlled snake, -1 when watching
+    int turn = -1;         // direction pressed since the last tick, -1 when none
+    std::string out;
+    size_t sent = 0;       // bytes of out already written
+    bool writable = false; // registered for EPOLLOUT
+};
+
+class SnakeServer {
+private:
+    ServerConfig config;
+    ThreadPool pool;
+    Arena arena;
+    int epollFd;
+    int listenFd;
+    int timerFd;
+    int signalFd;
+    std::vector<std::unique_ptr<Client>> clients; // indexed by fd
+    std::vector<int> controller;                  // snake -> client fd, -1 for bots
+    std::vector<uint8_t> actions;
+    std::vector<Xoshiro256> rngs;
+    std::string delta;     // this tick's delta, shared by every client
+    std::string snapshot;  // built at most once per tick, for clients that fell behind
+    int64_t snapshotTick;
+    int64_t bytesSent;
+    int clientCount;
+    int peakClients;
+
+    bool watch(int fd, uint32_t events, int op);
+    void accept();
+    void drop(int fd);
+    void read(Client& client);
+    bool flush(Client& client);
+    void send(Client& client, const std::string& frames);
+    void resync(Client& client);
+    void tick();
+
+public:
+    explicit SnakeServer(const ServerConfig& config);
+    ~SnakeServer();
+    SnakeServer(const SnakeServer&) = delete;
+    SnakeServer& operator=(const SnakeServer&) = delete;
+
+    // Bind the socket and start the tick timer; false with a message on failure
+    bool open();
+    // Serve until SIGINT or SIGTERM
+    void run();
+};
+
+static ArenaConfig arena_config(const ServerConfig& config) {
+    ArenaConfig arenaConfig;
+    arenaConfig.width = config.width;
+    arenaConfig.height = config.height;
+    arenaConfig.snakes = config.snakes;
+    arenaConfig.food = config.food;
+    arenaConfig.seed = config.seed;
+    return arenaConfig;
+}
+
+// SnakeServer class implementation
+SnakeServer::SnakeServer(const ServerConfig& config)
+    : config(config), pool(config.threads), arena(arena_config(config), &pool), epollFd(-1), listenFd(-1),
+      timerFd(-1), signalFd(-1), controller(config.snakes, -1), actions(config.snakes), rngs(config.snakes),
+      snapshotTick(-1), bytesSent(0), clientCount(0), peakClients(0) {
+    arena.recordChanges(true);
+    for (int k = 0; k < config.snakes; k++) {
+        uint64_t state = config.seed + static_cast<uint64_t>(k);
+        rngs[k].reseed(splitmix64(state));
+    }
+}
+
+SnakeServer::~SnakeServer() {
+    for (size_t fd = 0; fd < clients.size(); fd++) {
+        if (clients[fd]) ::close(static_cast<int>(fd));
+    }
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(config.socketPath.c_str());
+    }
+    if (timerFd >= 0) ::close(timerFd);
+    if (signalFd >= 0) ::close(signalFd);
+    if (epollFd >= 0) ::close(epollFd);
+}
+
+bool SnakeServer::watch(int fd, uint32_t events, int op) {
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    return ::epoll_ctl(epollFd, op, fd, &event) == 0;
+}
+
+// False if a live server already answers on addr. A socket file left behind
+// by a server that was killed refuses connections and is removed here.
+static bool claim_socket_path(const sockaddr_un& addr) {
+    int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        return true; // bind reports whatever is wrong
+    }
+    bool live = ::connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    int error = errno;
+    ::close(probe);
+    if (live) {
+        return false;
+    }
+    if (error == ECONNREFUSED) {
+        ::unlink(addr.sun_path);
+    }
+    return true;
+}
+
+bool SnakeServer::open() {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (config.socketPath.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "socket path too long: " << config.socketPath << std::endl;
+        return false;
+    }
+    std::strcpy(addr.sun_path, config.socketPath.c_str());
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (epollFd < 0 || listenFd < 0) {
+        std::perror("socket");
+        return false;
+    }
+    if (!claim_socket_path(addr)) {
+        std::cerr << config.socketPath << ": already in use" << std::endl;
+        ::close(listenFd);
+        listenFd = -1; // the path is not ours to remove
+        return false;
+    }
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0) {
+        std::perror(config.socketPath.c_str());
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    // Ticks and shutdown requests arrive as readable fds like everything else
+    timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    itimerspec interval = {};
+    interval.it_interval.tv_sec = config.tickMs / 1000;
+    interval.it_interval.tv_nsec = static_cast<long>(config.tickMs % 1000) * 1000000;
+    interval.it_value = interval.it_interval;
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    ::sigprocmask(SIG_BLOCK, &stopSignals, nullptr);
+    signalFd = ::signalfd(-1, &stopSignals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (timerFd < 0 || signalFd < 0 || ::timerfd_settime(timerFd, 0, &interval, nullptr) != 0) {
+        std::perror("timer");
+        return false;
+    }
+    return watch(listenFd, EPOLLIN, EPOLL_CTL_ADD) && watch(timerFd, EPOLLIN, EPOLL_CTL_ADD) &&
+           watch(signalFd, EPOLLIN, EPOLL_CTL_ADD);
+}
+
+void SnakeServer::accept() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) std::perror("accept");
+            return;
+        }
+        if (!watch(fd, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD)) {
+            ::close(fd);
+            continue;
+        }
+        if (clients.size() <= static_cast<size_t>(fd)) {
+            clients.resize(fd + 1);
+        }
+        clients[fd].reset(new Client());
+        Client& client = *clients[fd];
+        client.fd = fd;
+        peakClients = std::max(peakClients, ++clientCount);
+        encode_welcome(client.out, arena, -1);
+        encode_snapshot(client.out, arena);
+        if (!flush(client)) drop(fd);
+    }
+}
+
+void SnakeServer::drop(int fd) {
+    Client& client = *clients[fd];
+    if (client.snake >= 0) {
+        controller[client.snake] = -1; // back to the bots
+    }
+    ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    clients[fd].reset();
+    clientCount--;
+}
+
+void SnakeServer::read(Client& client) {
+    char buffer[256];
+    while (true) {
+        ssize_t n = ::recv(client.fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (n <= 0) {
+            drop(client.fd);
+            return;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            uint8_t command = static_cast<uint8_t>(buffer[i]);
+            if (command < 4) {
+                // The last turn pressed before the tick wins
+                if (client.snake >= 0) client.turn = command;
+            } else if (command == CMD_JOIN && client.snake < 0) {
+                for (int k = 0; k < arena.size(); k++) {
+                    if (controller[k] < 0) {
+                        controller[k] = client.fd;
+                        client.snake = k;
+                        client.turn = -1;
+                        break;
+                    }
+                }
+                // Tell the client which snake it got, or -1 if all were taken
+                encode_welcome(client.out, arena, client.snake);
+            } else if (command == CMD_LEAVE && client.snake >= 0) {
+                controller[client.snake] = -1;
+                client.snake = -1;
+                encode_welcome(client.out, arena, -1);
+            }
+        }
+        if (!flush(client)) {
+            drop(client.fd);
+            return;
+        }
+    }
+}
+
+bool SnakeServer::flush(Client& client) {
+    while (client.sent < client.out.size()) {
+        ssize_t n = ::send(client.fd, client.out.data() + client.sent, client.out.size() - client.sent,
+                           MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Socket buffer full: let epoll say when there is room again
+            if (!client.writable) {
+                client.writable = watch(client.fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP, EPOLL_CTL_MOD);
+            }
+            return client.writable;
+        }
+        if (n <= 0) return false;
+        client.sent += static_cast<size_t>(n);
+        bytesSent += n;
+    }
+    client.out.clear();
+    client.sent = 0;
+    if (client.writable) {
+        client.writable = false;
+        return watch(client.fd, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_MOD);
+    }
+    return true;
+}
+
+void SnakeServer::send(Client& client, const std::string& frames) {
+    if (client.out.empty()) {
+        // Nothing queued: write straight from the shared buffer and only
+        // copy what the socket would not take
+        ssize_t n;
+        do {
+            n = ::send(client.fd, frames.data(), frames.size(), MSG_NOSIGNAL);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            drop(client.fd);
+            return;
+        }
+        size_t written = n > 0 ? static_cast<size_t>(n) : 0;
+        bytesSent += static_cast<int64_t>(written);
+        if (written == frames.size()) return;
+        client.out.assign(frames);
+        client.sent = written;
+    } else {
+        client.out.append(frames);
+    }
+    if (client.out.size() - client.sent > config.maxBacklog) {
+        resync(client);
+    }
+    if (!flush(client)) drop(client.fd);
+}
+
+void SnakeServer::resync(Client& client) {
+    // The client cannot keep up: forget the deltas it has not started
+    // receiving and send the whole board instead once there is room
+    size_t keep = 0;
+    while (keep < client.sent) {
+        const unsigned char* header = reinterpret_cast<const unsigned char*>(client.out.data() + keep);
+        uint32_t length = header[1] | header[2] << 8 | header[3] << 16 | static_cast<uint32_t>(header[4]) << 24;
+        keep += FRAME_HEADER_SIZE + length;
+    }
+    client.out.resize(keep);
+    if (snapshotTick != arena.tickCount()) {
+        snapshot.clear();
+        encode_snapshot(snapshot, arena);
+        snapshotTick = arena.tickCount();
+    }
+    client.out.append(snapshot);
+}
+
+void SnakeServer::tick() {
+    // Players' snakes take the last turn pressed; the rest are bots, which
+    // only read the arena and so can all decide at once
+    pool.parallelFor(arena.size(), 64, [&](int64_t begin, int64_t end, unsigned) {
+        for (int64_t k = begin; k < end; k++) {
+            int snake = static_cast<int>(k);
+            if (!arena.isAlive(snake)) {
+                actions[k] = 0;
+            } else if (controller[k] >= 0) {
+                int turn = clients[controller[k]]->turn;
+                actions[k] = static_cast<uint8_t>(turn >= 0 ? turn : arena.getDirection(snake));
+            } else {
+                actions[k] = arena_bot_move(arena, snake, rngs[k]);
+            }
+        }
+    });
+    for (int k = 0; k < arena.size(); k++) {
+        if (controller[k] >= 0) clients[controller[k]]->turn = -1;
+    }
+    arena.step(actions.data());
+
+    delta.clear();
+    encode_delta(delta, arena);
+    for (size_t fd = 0; fd < clients.size(); fd++) {
+        if (clients[fd]) send(*clients[fd], delta);
+    }
+}
+
+void SnakeServer::run() {
+    std::cout << "snake_server: " << arena.getBoard().width() << "x" << arena.getBoard().height() << ", "
+              << arena.size() << " snakes, " << config.tickMs << " ms ticks, listening on " << config.socketPath
+              << std::endl;
+    const int MAX_EVENTS = 256;
+    epoll_event events[MAX_EVENTS];
+    bool running = true;
+    while (running) {
+        int count = ::epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            std::perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                accept();
+            } else if (fd == timerFd) {
+                // Ticks missed while busy are skipped rather than run back to back
+                uint64_t expirations;
+                if (::read(timerFd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                    tick();
+                }
+            } else if (fd == signalFd) {
+                running = false;
+            } else if (static_cast<size_t>(fd) < clients.size() && clients[fd]) {
+                Client& client = *clients[fd];
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    drop(fd);
+                    continue;
+                }
+                if ((events[i].events & EPOLLOUT) && !flush(client)) {
+                    drop(fd);
+                    continue;
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                    read(client);
+                }
+            }
+        }
+    }
+    std::cout << "snake_server: " << arena.tickCount() << " ticks, peak " << peakClients << " clients, "
+              << bytesSent << " bytes sent" << std::endl;
+}
+
+static void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [--socket PATH] [--width N] [--height N] [--snakes N] [--food N]"
+              << " [--tick-ms N] [--seed N] [--threads N]" << std::endl;
+}
+
+static bool parse_args(int argc, char* argv[], ServerConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc) return false;
+        const char* value = argv[i + 1];
+        if (std::strcmp(argv[i], "--socket") == 0) {
+            config.socketPath = value;
+        } else if (std::strcmp(argv[i], "--width") == 0) {
+            config.width = std::atoi(value);
+        } else if (std::strcmp(argv[i], "--height") == 0) {
+            config.height = std::atoi(value);
+        } else if (std::strcmp(argv[i], "--snakes") == 0) {
+            config.snakes = std::atoi(value);
+        } else if (std::strcmp(argv[i], "--food") == 0) {
+            config.food = std::atoi(value);
+        } else if (std::strcmp(argv[i], "--tick-ms") == 0) {
+            config.tickMs = std::atoi(value);
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            config.threads = static_cast<unsigned>(std::atoi(value));
+        } else {
+            return false;
+        }
+        ++i;
+    }
+    if (config.food == 0) config.food = 2 * config.snakes;
+    return config.width > 0 && config.height > 0 && config.snakes > 0 && config.food > 0 && config.tickMs > 0;
+}
+
+int main(int argc, char* argv[]) {
+    ServerConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    SnakeServer server(config);
+    if (!server.open()) {
+        return 1;
+    }
+    server.run();
+    return 0;
+}
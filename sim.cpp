@@ -0,0 +1,257 @@
+#include "engine.h"
+#include "agent.h"
+#include "arena.h"
+#include "thread_pool.h"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+// How a simulated game ended
+enum DeathCause { DEATH_SELF, DEATH_POISON, DEATH_WON, DEATH_TICK_LIMIT, DEATH_CAUSES };
+
+static const char* const DEATH_NAMES[DEATH_CAUSES] = {"hit self", "poisoned", "won", "tick limit"};
+
+struct SimConfig {
+    int64_t games = 100000;
+    unsigned threads = std::thread::hardware_concurrency();
+    uint64_t seed = 1;
+    int width = 0;       // 0 picks BOARD_SIZE, or 256 in arena mode
+    int height = 0;
+    int64_t maxTicks = 0; // 0 picks 100000 per game, or 10000 arena ticks
+    std::string agent = "greedy";
+    int arenaSnakes = 0;  // > 0 runs one shared arena instead of separate games
+    int arenaFood = 0;    // 0 picks two per snake
+};
+
+// Per-worker totals, merged once every game has finished. Cache-line aligned
+// so workers bumping their own counters never contend.
+struct alignas(64) SimStats {
+    std::vector<int64_t> lengthCounts; // games that ended at each snake length
+    int64_t deaths[DEATH_CAUSES] = {};
+    int64_t games = 0;
+    int64_t ticks = 0;
+    int64_t lengthSum = 0;
+
+    void merge(const SimStats& other) {
+        if (lengthCounts.size() < other.lengthCounts.size()) {
+            lengthCounts.resize(other.lengthCounts.size(), 0);
+        }
+        for (size_t i = 0; i < other.lengthCounts.size(); i++) {
+            lengthCounts[i] += other.lengthCounts[i];
+        }
+        for (int i = 0; i < DEATH_CAUSES; i++) {
+            deaths[i] += other.deaths[i];
+        }
+        games += other.games;
+        ticks += other.ticks;
+        lengthSum += other.lengthSum;
+    }
+};
+
+// Spreads consecutive game indices into unrelated seeds
+static uint64_t mix_seed(uint64_t x) {
+    return splitmix64(x);
+}
+
+static void play_game(const SimConfig& config, uint64_t seed, Agent& agent, SimStats& stats) {
+    SnakeEngine engine(DynamicBoard(config.width, config.height), seed);
+    agent.reset(seed);
+
+    DeathCause cause = DEATH_TICK_LIMIT;
+    int64_t ticks = 0;
+    while (ticks < config.maxTicks) {
+        TickResult result = engine.step(agent.chooseMove(engine));
+        ticks++;
+        if (result == TickResult::HitSelf) {
+            cause = DEATH_SELF;
+            break;
+        } else if (result == TickResult::Poisoned) {
+            cause = DEATH_POISON;
+            break;
+        } else if (result == TickResult::Won) {
+            cause = DEATH_WON;
+            break;
+        }
+    }
+
+    size_t length = engine.getSnake().size();
+    if (stats.lengthCounts.size() <= length) {
+        stats.lengthCounts.resize(length + 1, 0);
+    }
+    stats.lengthCounts[length]++;
+    stats.deaths[cause]++;
+    stats.games++;
+    stats.ticks += ticks;
+    stats.lengthSum += static_cast<int64_t>(length);
+}
+
+// Smallest length such that at least fraction of games ended at or below it
+static size_t length_percentile(const SimStats& stats, double fraction) {
+    int64_t target = static_cast<int64_t>(fraction * stats.games);
+    int64_t seen = 0;
+    for (size_t length = 0; length < stats.lengthCounts.size(); length++) {
+        seen += stats.lengthCounts[length];
+        if (seen > target) return length;
+    }
+    return stats.lengthCounts.empty() ? 0 : stats.lengthCounts.size() - 1;
+}
+
+static void print_report(const SimConfig& config, const SimStats& stats, double seconds, unsigned threads) {
+    // Scores are awarded as 10 points per segment, as in the interactive game
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "=== Simulation ===\n";
+    std::cout << "games: " << stats.games << " on " << config.width << "x" << config.height
+              << " with " << threads << " threads, " << config.agent << " agent\n";
+    std::cout << "elapsed: " << seconds << " s\n";
+    std::cout << "games/sec: " << stats.games / seconds << "\n";
+    std::cout << "ticks/sec: " << stats.ticks / seconds << "\n";
+    std::cout << "mean length: " << static_cast<double>(stats.lengthSum) / stats.games << "\n";
+    std::cout << "mean ticks: " << static_cast<double>(stats.ticks) / stats.games << "\n";
+
+    std::cout << "\n=== Score distribution ===\n";
+    const double fractions[] = {0.10, 0.50, 0.90, 0.99, 1.0};
+    const char* const labels[] = {"p10", "p50", "p90", "p99", "max"};
+    for (int i = 0; i < 5; i++) {
+        std::cout << labels[i] << ": " << length_percentile(stats, fractions[i]) * 10 << "\n";
+    }
+
+    std::cout << "\n=== Death causes ===\n";
+    for (int i = 0; i < DEATH_CAUSES; i++) {
+        std::cout << std::setw(11) << std::left << DEATH_NAMES[i] << std::right << ": "
+                  << stats.deaths[i] << " (" << 100.0 * stats.deaths[i] / stats.games << "%)\n";
+    }
+}
+
+static int run_arena(const SimConfig& config, ThreadPool& pool) {
+    ArenaConfig arenaConfig;
+    arenaConfig.width = config.width;
+    arenaConfig.height = config.height;
+    arenaConfig.snakes = config.arenaSnakes;
+    arenaConfig.food = config.arenaFood;
+    arenaConfig.seed = config.seed;
+    Arena arena(arenaConfig, &pool);
+
+    std::vector<uint8_t> actions(arena.size());
+    std::vector<Xoshiro256> rngs(arena.size());
+    for (int k = 0; k < arena.size(); k++) {
+        rngs[k].reseed(mix_seed(config.seed + static_cast<uint64_t>(k)));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t tick = 0; tick < config.maxTicks; tick++) {
+        // Bots only read the arena, so they can all decide at once
+        pool.parallelFor(arena.size(), 64, [&](int64_t begin, int64_t end, unsigned) {
+            for (int64_t k = begin; k < end; k++) {
+                int snake = static_cast<int>(k);
+                actions[k] = arena.isAlive(snake) ? arena_bot_move(arena, snake, rngs[k]) : 0;
+            }
+        });
+        arena.step(actions.data());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ArenaStats stats = arena.stats();
+    int longest = 0;
+    int64_t best = 0;
+    for (int k = 0; k < arena.size(); k++) {
+        longest = std::max(longest, arena.body(k).size());
+        best = std::max(best, arena.score(k));
+    }
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "=== Arena ===\n";
+    std::cout << "snakes: " << arena.size() << " on " << config.width << "x" << config.height << " in "
+              << arena.regionCountUsed() << " regions with " << pool.size() << " threads\n";
+    std::cout << "elapsed: " << seconds << " s\n";
+    std::cout << "ticks/sec: " << stats.ticks / seconds << "\n";
+    std::cout << "snake moves/sec: " << static_cast<double>(stats.ticks) * arena.size() / seconds << "\n";
+    std::cout << "food eaten: " << stats.eaten << "\n";
+    std::cout << "head-on deaths: " << stats.headOn << "\n";
+    std::cout << "body deaths: " << stats.hitBody << "\n";
+    std::cout << "alive at end: " << stats.alive << "\n";
+    std::cout << "longest snake: " << longest << "\n";
+    std::cout << "best score: " << best << "\n";
+    return 0;
+}
+
+static void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [--games N] [--threads N] [--seed N]"
+              << " [--width N] [--height N] [--max-ticks N] [--agent NAME]\n"
+              << "       " << prog << " --arena SNAKES [--food N] [--threads N] [--seed N]"
+              << " [--width N] [--height N] [--max-ticks N]\n"
+              << "Agents: " << AGENT_NAMES << std::endl;
+}
+
+static bool parse_args(int argc, char* argv[], SimConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc) return false;
+        const char* value = argv[i + 1];
+        if (std::strcmp(argv[i], "--games") == 0) {
+            config.games = std::atoll(value);
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            config.threads = static_cast<unsigned>(std::atoi(value));
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(argv[i], "--width") == 0) {
+            config.width = std::atoi(value);
+        } else if (std::strcmp(argv[i], "--height") == 0) {
+            config.height = std::atoi(value);
+        } else if (std::strcmp(argv[i], "--max-ticks") == 0) {
+            config.maxTicks = std::atoll(value);
+        } else if (std::strcmp(argv[i], "--agent") == 0) {
+            config.agent = value;
+        } else if (std::strcmp(argv[i], "--arena") == 0) {
+            config.arenaSnakes = std::atoi(value);
+        } else if (std::strcmp(argv[i], "--food") == 0) {
+            config.arenaFood = std::atoi(value);
+        } else {
+            return false;
+        }
+        ++i;
+    }
+    bool arena = config.arenaSnakes > 0;
+    if (config.width == 0) config.width = arena ? 256 : BOARD_SIZE;
+    if (config.height == 0) config.height = arena ? 256 : BOARD_SIZE;
+    if (config.maxTicks == 0) config.maxTicks = arena ? 10000 : 100000;
+    if (config.arenaFood == 0) config.arenaFood = 2 * config.arenaSnakes;
+    return config.arenaSnakes >= 0 && config.arenaFood >= 0 && config.games > 0 && config.width > 0 &&
+           config.height > 0 && config.maxTicks > 0 &&
+           make_agent(config.agent, DynamicBoard(config.width, config.height)) != nullptr;
+}
+
+int main(int argc, char* argv[]) {
+    SimConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    ThreadPool pool(config.threads);
+    if (config.arenaSnakes > 0) {
+        return run_arena(config, pool);
+    }
+    std::vector<SimStats> perWorker(pool.size());
+    // One agent per worker, reused across its games so search buffers are allocated once
+    std::vector<std::unique_ptr<Agent>> agents;
+    for (unsigned i = 0; i < pool.size(); i++) {
+        agents.push_back(make_agent(config.agent, DynamicBoard(config.width, config.height)));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(config.games, 64, [&](int64_t begin, int64_t end, unsigned worker) {
+        for (int64_t game = begin; game < end; game++) {
+            // Seeds depend only on the game index, so results do not depend on scheduling
+            play_game(config, mix_seed(mix_seed(config.seed) + static_cast<uint64_t>(game)), *agents[worker],
+                      perWorker[worker]);
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    SimStats total;
+    for (const SimStats& stats : perWorker) {
+        total.merge(stats);
+    }
+    print_report(config, total, seconds, pool.size());
+    return 0;
+}
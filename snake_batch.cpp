@@ -0,0 +1,160 @@
+#include "snake_batch.h"
+
+// SnakeBatch class implementation
+SnakeBatch::SnakeBatch(int games, int width, int height, uint64_t seed)
+    : games(games), width(width), height(height), cells(width * height), baseSeed(seed),
+      headRow(games), headCol(games), direction(games), length(games), tailPos(games),
+      food(games), poison(games), freeCount(games), seeds(games), episodes(games, 0), rngs(games),
+      nextCell(games), ateFood(games), atePoison(games),
+      results(games, static_cast<uint8_t>(TickResult::Moved)), rewards(games, 0.0f), dones(games, 0),
+      body(static_cast<size_t>(games) * cells), occupied(static_cast<size_t>(games) * cells),
+      freeCells(static_cast<size_t>(games) * cells), freeSlot(static_cast<size_t>(games) * cells) {
+    reset();
+}
+
+void SnakeBatch::reset() {
+    for (int k = 0; k < games; k++) {
+        resetGame(k);
+    }
+}
+
+void SnakeBatch::resetGame(int k) {
+    uint64_t state = baseSeed + static_cast<uint64_t>(k) * 0x100000000ULL + episodes[k]++;
+    seeds[k] = splitmix64(state);
+    rngs[k].reseed(seeds[k]);
+
+    size_t base = static_cast<size_t>(k) * cells;
+    std::fill(occupied.begin() + base, occupied.begin() + base + cells, 0);
+    for (int i = 0; i < cells; i++) {
+        freeCells[base + i] = i;
+        freeSlot[base + i] = i;
+    }
+    freeCount[k] = cells;
+    length[k] = 0;
+    tailPos[k] = 0;
+    direction[k] = ACTION_RIGHT;
+    headRow[k] = 0;
+    headCol[k] = 0;
+    pushHead(k, 0);
+    placeFood(k);
+    poison[k] = -1;
+}
+
+void SnakeBatch::pushHead(int k, int cell) {
+    size_t base = static_cast<size_t>(k) * cells;
+    int pos = tailPos[k] + length[k];
+    body[base + (pos >= cells ? pos - cells : pos)] = cell;
+    length[k]++;
+    occupied[base + cell] = 1;
+
+    // Swap-remove from the free list, exactly as SnakeEngine::pushHead does
+    int slot = freeSlot[base + cell];
+    int last = freeCells[base + --freeCount[k]];
+    freeCells[base + slot] = last;
+    freeSlot[base + last] = slot;
+    freeSlot[base + cell] = -1;
+}
+
+void SnakeBatch::popTail(int k) {
+    size_t base = static_cast<size_t>(k) * cells;
+    int cell = body[base + tailPos[k]];
+    tailPos[k] = tailPos[k] + 1 == cells ? 0 : tailPos[k] + 1;
+    length[k]--;
+    occupied[base + cell] = 0;
+    freeSlot[base + cell] = freeCount[k];
+    freeCells[base + freeCount[k]++] = cell;
+}
+
+int SnakeBatch::sampleFree(int k) {
+    return freeCells[static_cast<size_t>(k) * cells + rngs[k].below(freeCount[k])];
+}
+
+void SnakeBatch::placeFood(int k) {
+    food[k] = freeCount[k] > 0 ? sampleFree(k) : -1;
+}
+
+void SnakeBatch::placePoison(int k) {
+    // Uniform over free cells other than the food, as in SnakeEngine::generatePoisonFood
+    int candidates = freeCount[k] - 1;
+    if (candidates <= 0) {
+        poison[k] = -1;
+        return;
+    }
+    size_t base = static_cast<size_t>(k) * cells;
+    int cell = freeCells[base + rngs[k].below(candidates)];
+    if (cell == food[k]) {
+        cell = freeCells[base + candidates];
+    }
+    poison[k] = cell;
+}
+
+void SnakeBatch::step(const uint8_t* actions) {
+    const int w = width;
+    const int h = height;
+    int32_t* rows = headRow.data();
+    int32_t* cols = headCol.data();
+    uint8_t* dirs = direction.data();
+    int32_t* next = nextCell.data();
+    const int32_t* foodAt = food.data();
+    const int32_t* poisonAt = poison.data();
+    uint8_t* ate = ateFood.data();
+    uint8_t* poisoned = atePoison.data();
+
+    // Branch-free head computation and wraparound over every game
+    for (int k = 0; k < games; k++) {
+        uint8_t action = actions[k] & 3;
+        uint8_t dir = (action ^ dirs[k]) == 1 ? dirs[k] : action;
+        dirs[k] = dir;
+        int dc = (dir == ACTION_RIGHT) - (dir == ACTION_LEFT);
+        int dr = (dir == ACTION_DOWN) - (dir == ACTION_UP);
+        int row = rows[k] + dr;
+        int col = cols[k] + dc;
+        row += (row < 0) * h - (row >= h) * h;
+        col += (col < 0) * w - (col >= w) * w;
+        rows[k] = row;
+        cols[k] = col;
+        next[k] = row * w + col;
+    }
+
+    // Food and poison hits, also branch-free
+    for (int k = 0; k < games; k++) {
+        ate[k] = next[k] == foodAt[k];
+        poisoned[k] = next[k] == poisonAt[k];
+    }
+
+    // Per-game collision and body updates
+    for (int k = 0; k < games; k++) {
+        size_t base = static_cast<size_t>(k) * cells;
+        TickResult result;
+        if (occupied[base + next[k]]) {
+            result = TickResult::HitSelf;
+        } else if (ate[k]) {
+            pushHead(k, next[k]);
+            if (freeCount[k] == 0) {
+                result = TickResult::Won;
+            } else {
+                placeFood(k);
+                if (rngs[k].below(POISON_CHANCE) == 0) {
+                    placePoison(k);
+                } else {
+                    poison[k] = -1;
+                }
+                result = TickResult::Ate;
+            }
+        } else if (poisoned[k]) {
+            result = TickResult::Poisoned;
+        } else {
+            pushHead(k, next[k]);
+            popTail(k);
+            result = TickResult::Moved;
+        }
+
+        results[k] = static_cast<uint8_t>(result);
+        bool done = result != TickResult::Moved && result != TickResult::Ate;
+        dones[k] = done;
+        rewards[k] = result == TickResult::Ate || result == TickResult::Won ? 1.0f : (done ? -1.0f : 0.0f);
+        if (done) {
+            resetGame(k);
+        }
+    }
+}
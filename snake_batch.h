@@ -0,0 +1,103 @@
+#ifndef SNAKE_BATCH_H
+#define SNAKE_BATCH_H
+
+#include "engine.h"
+#include <cstdint>
+#include <vector>
+
+// Action codes for batched stepping. Opposite moves differ only in the low
+// bit, so "is this a reversal" is a single XOR.
+enum BatchAction : uint8_t {
+    ACTION_RIGHT = 0,
+    ACTION_LEFT = 1,
+    ACTION_UP = 2,
+    ACTION_DOWN = 3
+};
+static_assert(ACTION_RIGHT == DIR_RIGHT && ACTION_LEFT == DIR_LEFT && ACTION_UP == DIR_UP && ACTION_DOWN == DIR_DOWN,
+              "batch actions and engine directions share one numbering");
+
+// Structure-of-arrays engine that advances K games of the same board size in
+// lockstep. Heads, directions, lengths and food live in contiguous per-field
+// arrays so the head computation, wraparound and food checks run as plain
+// loops the compiler can vectorize; only the occupancy lookups and body
+// updates touch per-game memory. Game rules and random draws match
+// SnakeEngine exactly, so game k replays as SnakeEngine(board, gameSeed(k)).
+class SnakeBatch {
+private:
+    int games;
+    int width;
+    int height;
+    int cells;
+    uint64_t baseSeed;
+
+    // One entry per game
+    std::vector<int32_t> headRow;
+    std::vector<int32_t> headCol;
+    std::vector<uint8_t> direction;
+    std::vector<int32_t> length;
+    std::vector<int32_t> tailPos;   // ring index of the tail segment
+    std::vector<int32_t> food;      // cell index, -1 when none
+    std::vector<int32_t> poison;    // cell index, -1 when none
+    std::vector<int32_t> freeCount;
+    std::vector<uint64_t> seeds;
+    std::vector<uint64_t> episodes;
+    std::vector<Xoshiro256> rngs;
+
+    // Per-tick outputs and scratch
+    std::vector<int32_t> nextCell;
+    std::vector<uint8_t> ateFood;
+    std::vector<uint8_t> atePoison;
+    std::vector<uint8_t> results;   // TickResult of the last step
+    std::vector<float> rewards;
+    std::vector<uint8_t> dones;
+
+    // games * cells entries each
+    std::vector<int32_t> body;      // ring buffer of cell indices, tail first
+    std::vector<uint8_t> occupied;
+    std::vector<int32_t> freeCells;
+    std::vector<int32_t> freeSlot;
+
+    void pushHead(int k, int cell);
+    void popTail(int k);
+    int sampleFree(int k);
+    void placeFood(int k);
+    void placePoison(int k);
+
+public:
+    // Sizes are not checked here: games, width and height must be positive
+    // and each side at most MAX_BOARD_SIDE
+    SnakeBatch(int games, int width = BOARD_SIZE, int height = BOARD_SIZE, uint64_t seed = random_seed());
+
+    // Restart every game, or only game k, with its next episode seed
+    void reset();
+    void resetGame(int k);
+
+    // Advance every game by one tick using actions[k] for game k. Games that
+    // end are reported through results()/dones() and then restarted, so the
+    // batch never contains a finished game between calls.
+    void step(const uint8_t* actions);
+
+    int size() const { return games; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    // Seed of game k's current episode
+    uint64_t gameSeed(int k) const { return seeds[k]; }
+
+    // Raw per-game arrays, valid until the next step or reset
+    const int32_t* headRows() const { return headRow.data(); }
+    const int32_t* headCols() const { return headCol.data(); }
+    const uint8_t* directions() const { return direction.data(); }
+    const int32_t* lengths() const { return length.data(); }
+    const int32_t* foodCells() const { return food.data(); }
+    const int32_t* poisonCells() const { return poison.data(); }
+    const uint8_t* tickResults() const { return results.data(); }
+    const float* tickRewards() const { return rewards.data(); }
+    const uint8_t* tickDones() const { return dones.data(); }
+
+    // Board of game k: occupancy flags and body ring (tail at tailIndex(k))
+    const uint8_t* occupancy(int k) const { return occupied.data() + static_cast<size_t>(k) * cells; }
+    const int32_t* bodyRing(int k) const { return body.data() + static_cast<size_t>(k) * cells; }
+    int tailIndex(int k) const { return tailPos[k]; }
+};
+
+#endif
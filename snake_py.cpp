@@ -0,0 +1,216 @@
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include "snake_batch.h"
+#include "observation.h"
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace py = pybind11;
+
+// Observation layouts VecEnv can produce, named as in the Python API
+enum ObservationKind { OBS_PLANES, OBS_BODY_AGE, OBS_CROP };
+
+// Gym-style vector environment over one SnakeBatch. Observations, rewards,
+// done flags and the raw state arrays are handed to Python as NumPy views
+// of this object's memory: nothing is copied, and every view is overwritten
+// by the next reset() or step(), so callers that keep a step's data around
+// must copy it themselves.
+//
+// reset() and step() run without the GIL, so two Python threads can call
+// them on the same env at once; the mutex makes the second wait. Views
+// handed out earlier still change under the other thread, so sharing an
+// env between threads is only safe when neither keeps its arrays.
+class VecEnv {
+private:
+    SnakeBatch batch;
+    std::mutex busy; // held while the batch and observations are written
+    ObservationKind kind;
+    int radius;
+    std::vector<float> storage; // observations, over-allocated for alignment
+    float* observations;
+    size_t observationCount;
+
+    // SnakeBatch trusts its sizes, so they are checked before it is built
+    static int checked_games(int games, int width, int height) {
+        if (games <= 0) {
+            throw std::invalid_argument("num_envs must be positive");
+        }
+        if (width <= 0 || width > MAX_BOARD_SIDE || height <= 0 || height > MAX_BOARD_SIDE) {
+            throw std::invalid_argument("width and height must be between 1 and " + std::to_string(MAX_BOARD_SIDE));
+        }
+        return games;
+    }
+
+    void encode() {
+        if (kind == OBS_PLANES) {
+            encode_planes(batch, observations);
+        } else if (kind == OBS_BODY_AGE) {
+            encode_body_age(batch, observations);
+        } else {
+            encode_crops(batch, radius, observations);
+        }
+    }
+
+public:
+    VecEnv(int games, int width, int height, uint64_t seed, const std::string& observation, int cropRadius)
+        : batch(checked_games(games, width, height), width, height, seed), radius(cropRadius), observations(nullptr), observationCount(0) {
+        if (observation == "planes") {
+            kind = OBS_PLANES;
+            observationCount = planes_size(batch);
+        } else if (observation == "age") {
+            kind = OBS_BODY_AGE;
+            observationCount = body_age_size(batch);
+        } else if (observation == "crop") {
+            if (cropRadius < 0 || cropRadius > MAX_CROP_RADIUS) {
+                throw std::invalid_argument("crop_radius must be between 0 and " + std::to_string(MAX_CROP_RADIUS));
+            }
+            kind = OBS_CROP;
+            observationCount = crop_size(batch, cropRadius);
+        } else {
+            throw std::invalid_argument("observation must be 'planes', 'age' or 'crop'");
+        }
+        const size_t pad = OBSERVATION_ALIGNMENT / sizeof(float);
+        storage.assign(observationCount + pad, 0.0f);
+        void* start = storage.data();
+        size_t space = storage.size() * sizeof(float);
+        observations = static_cast<float*>(std::align(OBSERVATION_ALIGNMENT, observationCount * sizeof(float),
+                                                      start, space));
+        encode();
+    }
+    // observations points into storage
+    VecEnv(const VecEnv&) = delete;
+    VecEnv& operator=(const VecEnv&) = delete;
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(busy);
+        batch.reset();
+        encode();
+    }
+
+    void step(const uint8_t* actions) {
+        std::lock_guard<std::mutex> lock(busy);
+        batch.step(actions);
+        encode();
+    }
+
+    const SnakeBatch& getBatch() const { return batch; }
+    float* getObservations() { return observations; }
+
+    // NumPy shape of one observation
+    std::vector<py::ssize_t> observationShape() const {
+        const py::ssize_t side = 2 * radius + 1;
+        if (kind == OBS_PLANES) return {PLANE_COUNT, batch.getHeight(), batch.getWidth()};
+        if (kind == OBS_BODY_AGE) return {batch.getHeight(), batch.getWidth()};
+        return {CROP_CHANNEL_COUNT, side, side};
+    }
+};
+
+// Read-only NumPy array over memory owned by the env; base keeps the env
+// alive for as long as the array is
+template <typename T>
+static py::array view(py::handle base, const T* data, std::vector<py::ssize_t> shape,
+                      py::dtype dtype = py::dtype::of<T>()) {
+    std::vector<py::ssize_t> strides(shape.size());
+    py::ssize_t stride = static_cast<py::ssize_t>(sizeof(T));
+    for (size_t i = shape.size(); i-- > 0;) {
+        strides[i] = stride;
+        stride *= shape[i];
+    }
+    py::array array(dtype, shape, strides, data, base);
+    array.attr("setflags")(py::arg("write") = false);
+    return array;
+}
+
+static py::array observation_view(py::object self) {
+    VecEnv& env = self.cast<VecEnv&>();
+    std::vector<py::ssize_t> shape = env.observationShape();
+    shape.insert(shape.begin(), env.getBatch().size());
+    return view(self, env.getObservations(), shape);
+}
+
+PYBIND11_MODULE(snake_env, m) {
+    m.doc() = "Batched snake games for reinforcement learning";
+
+    m.attr("ACTION_RIGHT") = static_cast<int>(ACTION_RIGHT);
+    m.attr("ACTION_LEFT") = static_cast<int>(ACTION_LEFT);
+    m.attr("ACTION_UP") = static_cast<int>(ACTION_UP);
+    m.attr("ACTION_DOWN") = static_cast<int>(ACTION_DOWN);
+
+    py::class_<VecEnv>(m, "VecEnv",
+                       "num_envs games on a width x height board stepped together.\n"
+                       "observation is 'planes' (head/body/food/poison one-hot planes), 'age'\n"
+                       "(body-age plane) or 'crop' (egocentric window of crop_radius cells).\n"
+                       "Every array returned is a read-only view that the next reset() or\n"
+                       "step() overwrites; copy it to keep it. Calls from several threads on\n"
+                       "one env are serialized, but each overwrites the others' views.")
+        .def(py::init<int, int, int, uint64_t, const std::string&, int>(), py::arg("num_envs"),
+             py::arg("width") = BOARD_SIZE, py::arg("height") = BOARD_SIZE, py::arg("seed") = 1,
+             py::arg("observation") = "planes", py::arg("crop_radius") = 5)
+        .def("reset",
+             [](py::object self) {
+                 VecEnv& env = self.cast<VecEnv&>();
+                 {
+                     py::gil_scoped_release release;
+                     env.reset();
+                 }
+                 return observation_view(self);
+             },
+             "Restart every game; returns the observations")
+        .def("step",
+             [](py::object self, py::array_t<uint8_t, py::array::c_style | py::array::forcecast> actions) {
+                 VecEnv& env = self.cast<VecEnv&>();
+                 const SnakeBatch& batch = env.getBatch();
+                 if (actions.ndim() != 1 || actions.shape(0) != batch.size()) {
+                     throw std::invalid_argument("actions must be a 1-d array with one entry per env");
+                 }
+                 const uint8_t* codes = actions.data();
+                 {
+                     // Python threads driving other envs run while this one steps
+                     py::gil_scoped_release release;
+                     env.step(codes);
+                 }
+                 std::vector<py::ssize_t> perGame = {batch.size()};
+                 return py::make_tuple(observation_view(self), view(self, batch.tickRewards(), perGame),
+                                       view(self, batch.tickDones(), perGame, py::dtype("bool")),
+                                       view(self, batch.tickResults(), perGame));
+             },
+             py::arg("actions"),
+             "Advance every game one tick; returns (observations, rewards, dones, results).\n"
+             "Finished games restart at once, so observations show the new game.")
+        .def_property_readonly("num_envs", [](const VecEnv& env) { return env.getBatch().size(); })
+        .def_property_readonly("observation_shape",
+                               [](const VecEnv& env) {
+                                   std::vector<py::ssize_t> shape = env.observationShape();
+                                   py::tuple out(shape.size());
+                                   for (size_t i = 0; i < shape.size(); i++) {
+                                       out[i] = py::int_(shape[i]);
+                                   }
+                                   return out;
+                               })
+        .def_property_readonly("head_rows",
+                               [](py::object self) {
+                                   const SnakeBatch& batch = self.cast<VecEnv&>().getBatch();
+                                   return view(self, batch.headRows(), {batch.size()});
+                               })
+        .def_property_readonly("head_cols",
+                               [](py::object self) {
+                                   const SnakeBatch& batch = self.cast<VecEnv&>().getBatch();
+                                   return view(self, batch.headCols(), {batch.size()});
+                               })
+        .def_property_readonly("lengths",
+                               [](py::object self) {
+                                   const SnakeBatch& batch = self.cast<VecEnv&>().getBatch();
+                                   return view(self, batch.lengths(), {batch.size()});
+                               })
+        .def("game_seed",
+             [](const VecEnv& env, int k) {
+                 if (k < 0 || k >= env.getBatch().size()) {
+                     throw py::index_error("env index out of range");
+                 }
+                 return env.getBatch().gameSeed(k);
+             },
+             py::arg("k"),
+             "Seed of game k's current episode, to replay it with the engine");
+}
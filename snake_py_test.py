@@ -0,0 +1,62 @@
+# Smoke test for the snake_env module; ctest runs it when pybind11 is found
+import threading
+
+import numpy as np
+import snake_env
+
+env = snake_env.VecEnv(8, width=6, height=5, seed=3, observation="planes")
+first = env.reset()
+assert first.shape == (8,) + env.observation_shape
+assert first.dtype == np.float32
+
+actions = np.full(env.num_envs, snake_env.ACTION_RIGHT, dtype=np.uint8)
+obs, rewards, dones, results = env.step(actions)
+assert rewards.shape == dones.shape == results.shape == (8,)
+assert dones.dtype == np.bool_
+
+# Every array is a read-only view of the env's own buffers: the next step
+# writes into the same memory and the arrays keep the env alive
+later = env.step(actions)
+for before, after in zip((obs, rewards, dones, results), later):
+    assert np.shares_memory(before, after)
+assert np.shares_memory(first, obs)
+for array in (obs, rewards, dones, results, env.head_rows, env.head_cols, env.lengths):
+    assert array.base is env
+    assert not array.flags.writeable
+    try:
+        array[0] = 0
+    except ValueError:
+        pass
+    else:
+        raise AssertionError("a view of the env accepted a write")
+
+# Steps from two threads on one env are serialized, not interleaved
+def drive():
+    moves = np.zeros(env.num_envs, dtype=np.uint8)
+    for i in range(200):
+        moves[:] = i % 4
+        env.step(moves)
+
+threads = [threading.Thread(target=drive) for _ in range(2)]
+for thread in threads:
+    thread.start()
+for thread in threads:
+    thread.join()
+assert np.all(env.lengths >= 1)
+
+try:
+    env.step(np.zeros(3, dtype=np.uint8))
+except ValueError:
+    pass
+else:
+    raise AssertionError("step accepted the wrong number of actions")
+
+# Sizes are checked before any game is built
+for games, width, height in ((0, 6, 5), (-1, 6, 5), (4, 0, 5), (4, 6, 0), (4, -6, 5), (4, 5000, 5)):
+    try:
+        snake_env.VecEnv(games, width=width, height=height)
+    except ValueError:
+        pass
+    else:
+        raise AssertionError("VecEnv accepted %d games of %dx%d" % (games, width, height))
+print("snake_env smoke test passed")
@@ -1,10 +1,17 @@
 #include <gtest/gtest.h>
 #include "snake.h"
+#include "agent.h"
+#include "arena.h"
+#include "protocol.h"
+#include "thread_pool.h"
+#include "snake_batch.h"
+#include "observation.h"
+#include "score_store.h"
+#include "game_log.h"
+#include "spsc_queue.h"
 #include <vector>
 #include <algorithm>
-
-// Provide definition for the global game pointer used by input/game functions
-SnakeGame* g_game = nullptr;
+#include <sstream>
 
 // Test fixture for SnakeGame tests
 class SnakeGameTest : public ::testing::Test {
@@ -156,6 +163,1196 @@ TEST_F(SnakeGameTest, PoisonFoodGeneration) {
     EXPECT_EQ(poisonFood, std::make_pair(-1, -1));
 }
 
+// Headless engine tests
+TEST(SnakeEngineTest, StepAdvancesHead) {
+    SnakeEngine engine;
+    TickResult result = engine.step(DIR_RIGHT);
+    EXPECT_TRUE(result == TickResult::Moved || result == TickResult::Ate);
+    EXPECT_EQ(engine.getSnake().back(), std::make_pair(0, 1));
+    EXPECT_FALSE(engine.isOver());
+}
+
+TEST(SnakeEngineTest, StepIgnoresReversal) {
+    SnakeEngine engine;
+    engine.step(DIR_LEFT); // opposite of the initial RIGHT
+    EXPECT_EQ(engine.getDirection(), DIR_RIGHT);
+    EXPECT_EQ(engine.getSnake().back(), std::make_pair(0, 1));
+}
+
+TEST(SnakeEngineTest, StepRunsWithoutSleeping) {
+    SnakeEngine engine;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 1000 && !engine.isOver(); ++i) {
+        engine.step(i % 20 < 10 ? DIR_RIGHT : DIR_DOWN);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count(), 100);
+}
+
+TEST(SnakeEngineTest, OccupancyTracksBody) {
+    SnakeEngine engine;
+    EXPECT_TRUE(engine.isOccupied(std::make_pair(0, 0)));
+    for (int i = 0; i < 200 && !engine.isOver(); ++i) {
+        engine.step(i % 20 < 10 ? DIR_RIGHT : DIR_DOWN);
+        const auto& snake = engine.getSnake();
+        int occupiedCells = 0;
+        for (int r = 0; r < BOARD_SIZE; ++r) {
+            for (int c = 0; c < BOARD_SIZE; ++c) {
+                bool onSnake = std::find(snake.begin(), snake.end(), std::make_pair(r, c)) != snake.end();
+                EXPECT_EQ(engine.isOccupied(std::make_pair(r, c)), onSnake);
+                occupiedCells += onSnake;
+            }
+        }
+        EXPECT_EQ(occupiedCells, static_cast<int>(snake.size()));
+        EXPECT_FALSE(engine.isOccupied(engine.getFood()));
+    }
+}
+
+TEST(SnakeEngineTest, BodyRingWrapsWithoutGrowing) {
+    SnakeBody body;
+    body.reset(4);
+    for (int cell = 0; cell < 3; ++cell) {
+        body.pushBack(cell);
+    }
+    // Crawl far enough that the ring wraps several times
+    for (int cell = 3; cell < 20; ++cell) {
+        body.pushBack(cell);
+        body.popFront();
+        EXPECT_EQ(body.size(), 3);
+        EXPECT_EQ(body.front(), cell - 2);
+        EXPECT_EQ(body.back(), cell);
+        EXPECT_EQ(body[1], cell - 1);
+    }
+    
+    DynamicBoard board(5, 4);
+    SnakeView<DynamicBoard> view(body, board);
+    std::vector<std::pair<int, int>> cells(view.begin(), view.end());
+    ASSERT_EQ(cells.size(), 3u);
+    EXPECT_EQ(cells[0], board.position(17));
+    EXPECT_EQ(cells[2], board.position(19));
+    EXPECT_EQ(view.back(), std::make_pair(3, 4));
+}
+
+TEST(SnakeEngineTest, PlaceSnakeRebuildsBoard) {
+    SnakeEngine engine(DynamicBoard(5, 5), 1);
+    std::vector<std::pair<int, int>> body = {{2, 0}, {2, 1}, {2, 2}, {2, 3}};
+    ASSERT_TRUE(engine.placeSnake(body, DIR_RIGHT));
+    EXPECT_EQ(engine.getSnake().size(), 4u);
+    EXPECT_EQ(engine.getHead(), std::make_pair(2, 3));
+    EXPECT_EQ(engine.freeCellCount(), 21);
+    EXPECT_TRUE(engine.isOccupied(std::make_pair(2, 0)));
+    EXPECT_FALSE(engine.isOccupied(engine.getFood()));
+    
+    // Off-board or repeated segments are rejected and leave the game as it was
+    EXPECT_FALSE(engine.placeSnake({{0, 0}, {0, 5}}, DIR_RIGHT));
+    EXPECT_FALSE(engine.placeSnake({{0, 0}, {0, 1}, {0, 0}}, DIR_RIGHT));
+    EXPECT_EQ(engine.getSnake().size(), 4u);
+}
+
+TEST(SnakeEngineTest, FillingTheBoardWins) {
+    SnakeEngine engine(DynamicBoard(3, 1));
+    int steps = 0;
+    TickResult result = TickResult::Moved;
+    while (!engine.isOver() && steps++ < 10) {
+        result = engine.step(DIR_RIGHT);
+    }
+    // The poison roll may end the game early; otherwise the snake must fill the row
+    if (result != TickResult::Poisoned) {
+        EXPECT_EQ(result, TickResult::Won);
+        EXPECT_TRUE(engine.isWon());
+        EXPECT_EQ(engine.getSnake().size(), 3);
+        EXPECT_EQ(engine.freeCellCount(), 0);
+        EXPECT_EQ(engine.getFood(), std::make_pair(-1, -1));
+    }
+}
+
+TEST(SnakeEngineTest, FoodAndPoisonLandOnFreeCells) {
+    for (int game = 0; game < 50; ++game) {
+        SnakeEngine engine(DynamicBoard(4, 4));
+        for (int i = 0; i < 200 && !engine.isOver(); ++i) {
+            engine.step(i % 8 < 4 ? DIR_RIGHT : DIR_DOWN);
+            if (engine.isOver()) break;
+            
+            auto food = engine.getFood();
+            auto poison = engine.getPoisonFood();
+            EXPECT_FALSE(engine.isOccupied(food));
+            if (poison != std::make_pair(-1, -1)) {
+                EXPECT_FALSE(engine.isOccupied(poison));
+                EXPECT_NE(poison, food);
+            }
+            EXPECT_EQ(engine.freeCellCount() + static_cast<int>(engine.getSnake().size()), 16);
+        }
+    }
+}
+
+TEST(SnakeEngineTest, SameSeedReplaysIdentically) {
+    SnakeEngine first(DynamicBoard(8, 8), 12345);
+    SnakeEngine second(DynamicBoard(8, 8), 12345);
+    const char dirs[] = {DIR_RIGHT, DIR_DOWN, DIR_LEFT, DIR_DOWN};
+    for (int i = 0; i < 500 && !first.isOver(); ++i) {
+        char dir = dirs[(i / 3) % 4];
+        EXPECT_EQ(first.step(dir), second.step(dir));
+        EXPECT_EQ(first.getSnake(), second.getSnake());
+        EXPECT_EQ(first.getFood(), second.getFood());
+        EXPECT_EQ(first.getPoisonFood(), second.getPoisonFood());
+    }
+    
+    // reset(seed) restarts the exact same game
+    auto food = SnakeEngine(DynamicBoard(8, 8), 777).getFood();
+    first.reset(777);
+    EXPECT_EQ(first.getFood(), food);
+    EXPECT_EQ(first.getSeed(), 777u);
+}
+
+TEST(SnakeEngineTest, RandomBelowStaysInRange) {
+    Xoshiro256 rng(42);
+    std::vector<int> hits(7, 0);
+    for (int i = 0; i < 7000; ++i) {
+        int value = rng.below(7);
+        ASSERT_GE(value, 0);
+        ASSERT_LT(value, 7);
+        hits[value]++;
+    }
+    for (int count : hits) {
+        EXPECT_GT(count, 800);
+    }
+}
+
+// Board geometry tests
+TEST(BoardTest, RectangularWrapAround) {
+    EXPECT_EQ(get_next_head(std::make_pair(2, 29), DIR_RIGHT, 30, 5), std::make_pair(2, 0));
+    EXPECT_EQ(get_next_head(std::make_pair(4, 7), DIR_DOWN, 30, 5), std::make_pair(0, 7));
+    EXPECT_EQ(get_next_head(std::make_pair(0, 7), DIR_UP, 30, 5), std::make_pair(4, 7));
+    EXPECT_EQ(get_next_head(std::make_pair(3, 0), DIR_LEFT, 30, 5), std::make_pair(3, 29));
+}
+
+TEST(BoardTest, FixedBoardsMatchDynamicBoard) {
+    FixedBoard<16, 8> masked;
+    FixedBoard<10, 6> folded;
+    DynamicBoard dynamicMasked(16, 8);
+    DynamicBoard dynamicFolded(10, 6);
+    static_assert(FixedBoard<16, 8>::POWER_OF_TWO, "16x8 should use the mask path");
+    static_assert(!FixedBoard<10, 6>::POWER_OF_TWO, "10x6 should use the compare path");
+    
+    // Every cell, so the last row and column exercise the wraps
+    const char dirs[] = {DIR_RIGHT, DIR_LEFT, DIR_UP, DIR_DOWN};
+    for (char dir : dirs) {
+        for (int r = 0; r < 8; ++r) {
+            for (int c = 0; c < 16; ++c) {
+                auto pos = std::make_pair(r, c);
+                EXPECT_EQ(masked.next(pos, dir), dynamicMasked.next(pos, dir));
+            }
+        }
+        for (int r = 0; r < 6; ++r) {
+            for (int c = 0; c < 10; ++c) {
+                auto pos = std::make_pair(r, c);
+                EXPECT_EQ(folded.next(pos, dir), dynamicFolded.next(pos, dir));
+            }
+        }
+    }
+}
+
+// Head, food, poison and score after each tick of a fixed walk
+template <typename Board>
+static std::vector<int> play_walk(BasicSnakeEngine<Board>& engine) {
+    const char moves[] = {DIR_RIGHT, DIR_RIGHT, DIR_DOWN, DIR_DOWN, DIR_LEFT, DIR_DOWN, DIR_RIGHT, DIR_UP};
+    std::vector<int> trace;
+    for (int tick = 0; tick < 60 && !engine.isOver(); ++tick) {
+        engine.step(moves[tick % 8]);
+        std::pair<int, int> head = engine.getSnake().back();
+        trace.insert(trace.end(), {head.first, head.second, engine.getFood().first, engine.getFood().second,
+                                   engine.getPoisonFood().first, engine.getPoisonFood().second, engine.getScore()});
+    }
+    return trace;
+}
+
+TEST(BoardTest, FixedBoardEngineMatchesDynamicEngine) {
+    // Same seed, same food: the games only differ in how the board wraps
+    BasicSnakeEngine<FixedBoard<16, 8>> masked(FixedBoard<16, 8>(), 11);
+    SnakeEngine dynamicMasked(DynamicBoard(16, 8), 11);
+    EXPECT_EQ(play_walk(masked), play_walk(dynamicMasked));
+
+    BasicSnakeEngine<FixedBoard<10, 6>> folded(FixedBoard<10, 6>(), 12);
+    SnakeEngine dynamicFolded(DynamicBoard(10, 6), 12);
+    auto foldedTrace = play_walk(folded);
+    EXPECT_EQ(foldedTrace, play_walk(dynamicFolded));
+    EXPECT_FALSE(foldedTrace.empty());
+}
+
+TEST(BoardTest, LargeRuntimeBoard) {
+    SnakeEngine engine(DynamicBoard(1000, 1000));
+    auto food = engine.getFood();
+    EXPECT_TRUE(food.first >= 0 && food.first < 1000);
+    EXPECT_TRUE(food.second >= 0 && food.second < 1000);
+    
+    for (int i = 0; i < 1000 && !engine.isOver(); ++i) {
+        engine.step(DIR_RIGHT);
+    }
+    EXPECT_EQ(engine.getSnake().back().first, 0);
+}
+
+// Batched engine tests
+TEST(SnakeBatchTest, MatchesSnakeEngineGameForGame) {
+    const char dirs[] = {DIR_RIGHT, DIR_LEFT, DIR_UP, DIR_DOWN};
+    const int games = 16;
+    SnakeBatch batch(games, 6, 5, 99);
+    std::vector<SnakeEngine> engines;
+    for (int k = 0; k < games; ++k) {
+        engines.emplace_back(DynamicBoard(6, 5), batch.gameSeed(k));
+    }
+    
+    Xoshiro256 rng(7);
+    std::vector<uint8_t> actions(games);
+    for (int tick = 0; tick < 2000; ++tick) {
+        for (int k = 0; k < games; ++k) {
+            actions[k] = static_cast<uint8_t>(rng.below(4));
+        }
+        batch.step(actions.data());
+        for (int k = 0; k < games; ++k) {
+            TickResult expected = engines[k].step(dirs[actions[k]]);
+            ASSERT_EQ(static_cast<TickResult>(batch.tickResults()[k]), expected);
+            if (engines[k].isOver()) {
+                EXPECT_TRUE(batch.tickDones()[k]);
+                engines[k] = SnakeEngine(DynamicBoard(6, 5), batch.gameSeed(k));
+            }
+            auto head = engines[k].getSnake().back();
+            ASSERT_EQ(batch.headRows()[k], head.first);
+            ASSERT_EQ(batch.headCols()[k], head.second);
+            ASSERT_EQ(batch.lengths()[k], static_cast<int>(engines[k].getSnake().size()));
+            auto food = engines[k].getFood();
+            ASSERT_EQ(batch.foodCells()[k], food.first < 0 ? -1 : food.first * 6 + food.second);
+        }
+    }
+}
+
+// Observation tests
+TEST(ObservationTest, EncodersMatchTheBatchState) {
+    const int games = 12;
+    const int w = 7;
+    const int h = 5;
+    const int radius = 4; // wider than the board, so crops wrap
+    const int side = 2 * radius + 1;
+    SnakeBatch batch(games, w, h, 31);
+    std::vector<float> planes(planes_size(batch));
+    std::vector<float> ages(body_age_size(batch));
+    std::vector<float> crops(crop_size(batch, radius));
+    
+    Xoshiro256 rng(5);
+    std::vector<uint8_t> actions(games);
+    for (int tick = 0; tick < 300; tick++) {
+        for (int k = 0; k < games; k++) {
+            actions[k] = static_cast<uint8_t>(rng.below(4));
+        }
+        batch.step(actions.data());
+        encode_planes(batch, planes.data());
+        encode_body_age(batch, ages.data(), 0, games / 2);
+        encode_body_age(batch, ages.data(), games / 2, games);
+        ASSERT_TRUE(encode_crops(batch, radius, crops.data()));
+        
+        for (int k = 0; k < games; k++) {
+            const float* p = planes.data() + static_cast<size_t>(k) * PLANE_COUNT * w * h;
+            const float* age = ages.data() + static_cast<size_t>(k) * w * h;
+            int head = batch.headRows()[k] * w + batch.headCols()[k];
+            for (int cell = 0; cell < w * h; cell++) {
+                ASSERT_EQ(p[PLANE_HEAD * w * h + cell], cell == head ? 1.0f : 0.0f);
+                ASSERT_EQ(p[PLANE_BODY * w * h + cell], batch.occupancy(k)[cell] ? 1.0f : 0.0f);
+                ASSERT_EQ(p[PLANE_FOOD * w * h + cell], cell == batch.foodCells()[k] ? 1.0f : 0.0f);
+                ASSERT_EQ(p[PLANE_POISON * w * h + cell], cell == batch.poisonCells()[k] ? 1.0f : 0.0f);
+                ASSERT_EQ(age[cell] > 0.0f, batch.occupancy(k)[cell] != 0);
+            }
+            ASSERT_EQ(age[head], 1.0f);
+            ASSERT_FLOAT_EQ(age[batch.bodyRing(k)[batch.tailIndex(k)]], 1.0f / batch.lengths()[k]);
+            
+            // Crop cell (r, c) lies r - radius rows behind and c - radius
+            // columns to the right of the head, as the snake sees it
+            const float* crop = crops.data() + static_cast<size_t>(k) * CROP_CHANNEL_COUNT * side * side;
+            uint8_t dir = batch.directions()[k];
+            for (int r = 0; r < side; r++) {
+                for (int c = 0; c < side; c++) {
+                    int ahead = radius - r;
+                    int right = c - radius;
+                    int dr = dir == ACTION_UP ? -ahead : dir == ACTION_DOWN ? ahead : dir == ACTION_RIGHT ? right : -right;
+                    int dc = dir == ACTION_UP ? right : dir == ACTION_DOWN ? -right : dir == ACTION_RIGHT ? ahead : -ahead;
+                    int row = ((batch.headRows()[k] + dr) % h + h) % h;
+                    int col = ((batch.headCols()[k] + dc) % w + w) % w;
+                    int cell = row * w + col;
+                    ASSERT_EQ(crop[CROP_BODY * side * side + r * side + c], batch.occupancy(k)[cell] ? 1.0f : 0.0f);
+                    ASSERT_EQ(crop[CROP_FOOD * side * side + r * side + c], cell == batch.foodCells()[k] ? 1.0f : 0.0f);
+                    ASSERT_EQ(crop[CROP_POISON * side * side + r * side + c],
+                              cell == batch.poisonCells()[k] ? 1.0f : 0.0f);
+                }
+            }
+        }
+    }
+    EXPECT_FALSE(encode_crops(batch, MAX_CROP_RADIUS + 1, crops.data()));
+}
+
+// Renderer tests
+static int count_occurrences(const std::string& text, const std::string& needle) {
+    int count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+TEST(RendererTest, FirstFrameDrawsEveryCell) {
+    SnakeEngine engine;
+    TerminalRenderer renderer;
+    const std::string& frame = renderer.render(engine, {"Score: 0 points"});
+    int cells = count_occurrences(frame, "⬜") + count_occurrences(frame, "🐍") +
+                count_occurrences(frame, "🍎") + count_occurrences(frame, "💀");
+    EXPECT_EQ(cells, BOARD_SIZE * BOARD_SIZE);
+    EXPECT_EQ(count_occurrences(frame, "Score: 0 points"), 1);
+}
+
+TEST(RendererTest, UnchangedFrameIsEmpty) {
+    SnakeEngine engine;
+    TerminalRenderer renderer;
+    renderer.render(engine, {"Score: 0 points"});
+    EXPECT_TRUE(renderer.render(engine, {"Score: 0 points"}).empty());
+}
+
+TEST(RendererTest, StepRedrawsOnlyChangedCells) {
+    SnakeEngine engine;
+    TerminalRenderer renderer;
+    renderer.render(engine, {});
+    TickResult result = engine.step(DIR_RIGHT);
+    const std::string& frame = renderer.render(engine, {});
+    if (result == TickResult::Moved) {
+        // Old tail cleared and new head drawn
+        EXPECT_EQ(count_occurrences(frame, "⬜"), 1);
+        EXPECT_EQ(count_occurrences(frame, "🐍"), 1);
+    } else {
+        // Head drawn over the eaten food plus the new food and maybe poison
+        EXPECT_LE(count_occurrences(frame, "\033["), 3);
+    }
+}
+
+// Input queue tests
+TEST(SpscQueueTest, PreservesOrderAcrossThreads) {
+    SpscQueue<int, 16> queue;
+    const int count = 10000;
+    std::thread producer([&] {
+        for (int i = 0; i < count; ++i) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    int expected = 0;
+    while (expected < count) {
+        int value;
+        if (queue.pop(value)) {
+            ASSERT_EQ(value, expected);
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, RejectsPushWhenFull) {
+    SpscQueue<int, 4> queue;
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_TRUE(queue.push(3));
+    EXPECT_FALSE(queue.push(4));
+    int value;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(queue.push(4));
+}
+
+TEST_F(SnakeGameTest, QueuedTurnsApplyOnePerTick) {
+    // Starting RIGHT: "up then left" pressed within one tick
+    game->postInput('w');
+    game->postInput('a');
+    EXPECT_EQ(game->getDirection(), DIR_RIGHT); // nothing applied until the game thread drains
+    
+    game->drainInput();
+    EXPECT_EQ(game->getPendingTurns(), 2);
+    EXPECT_TRUE(game->applyPendingTurn());
+    EXPECT_EQ(game->getDirection(), DIR_UP);
+    EXPECT_TRUE(game->applyPendingTurn());
+    EXPECT_EQ(game->getDirection(), DIR_LEFT);
+    EXPECT_FALSE(game->applyPendingTurn());
+}
+
+TEST_F(SnakeGameTest, QueuedReversalDoesNotUseTheTick) {
+    game->postInput('a'); // reversal of RIGHT, ignored
+    game->postInput('s');
+    game->postInput(PAUSE_KEY);
+    game->drainInput();
+    EXPECT_TRUE(game->isPaused()); // pause applies at once
+    EXPECT_TRUE(game->applyPendingTurn());
+    EXPECT_EQ(game->getDirection(), DIR_DOWN);
+    EXPECT_EQ(game->getPendingTurns(), 0);
+}
+
+TEST_F(SnakeGameTest, ArrowKeysSplitAcrossReads) {
+    // ESC [ A (up) arriving in two drains, then ESC [ 1 ; 2 D (shift+left)
+    for (char c : {'\x1b', '['}) game->postInput(c);
+    game->drainInput();
+    EXPECT_EQ(game->getPendingTurns(), 0);
+    game->postInput('A');
+    for (char c : {'\x1b', '[', '1', ';', '2', 'D'}) game->postInput(c);
+    game->drainInput();
+    EXPECT_EQ(game->getPendingTurns(), 2);
+    EXPECT_TRUE(game->applyPendingTurn());
+    EXPECT_EQ(game->getDirection(), DIR_UP);
+    EXPECT_TRUE(game->applyPendingTurn());
+    EXPECT_EQ(game->getDirection(), DIR_LEFT);
+}
+
+TEST(KeyMapTest, DirectionsAndOpposites) {
+    for (char dir : DIRECTIONS) {
+        EXPECT_TRUE(is_reverse(dir, dir ^ 1));
+        EXPECT_FALSE(is_reverse(dir, dir));
+        EXPECT_EQ(direction_index(dir), dir);
+    }
+    EXPECT_FALSE(is_reverse(DIR_RIGHT, DIR_UP));
+    EXPECT_EQ(DEFAULT_KEYMAP.lookup('d'), INPUT_RIGHT);
+    EXPECT_EQ(DEFAULT_KEYMAP.lookup(QUIT_KEY), INPUT_QUIT);
+    EXPECT_EQ(DEFAULT_KEYMAP.lookup('z'), INPUT_NONE);
+}
+
+TEST(KeyMapTest, CustomBindings) {
+    KeyMap keys = DEFAULT_KEYMAP;
+    ASSERT_TRUE(parse_key_bindings("ijklp", keys));
+    EXPECT_EQ(keys.lookup('i'), INPUT_UP);
+    EXPECT_EQ(keys.lookup('j'), INPUT_LEFT);
+    EXPECT_EQ(keys.lookup('k'), INPUT_DOWN);
+    EXPECT_EQ(keys.lookup('l'), INPUT_RIGHT);
+    EXPECT_EQ(keys.lookup('p'), INPUT_PAUSE);
+    EXPECT_EQ(keys.lookup('w'), INPUT_NONE); // old bindings are gone
+    EXPECT_EQ(keys.lookup(PAUSE_KEY), INPUT_NONE);
+    EXPECT_EQ(keys.lookup(QUIT_KEY), INPUT_QUIT); // not rebound
+
+    KeyMap unchanged = DEFAULT_KEYMAP;
+    EXPECT_FALSE(parse_key_bindings("wad", unchanged));
+    EXPECT_FALSE(parse_key_bindings("wwsd", unchanged));
+    EXPECT_EQ(unchanged.lookup('w'), INPUT_UP);
+
+    GameConfig config;
+    config.keys = keys;
+    SnakeGame game(config);
+    game.handleInput('k');
+    EXPECT_EQ(game.getDirection(), DIR_DOWN);
+    game.handleInput('s');
+    EXPECT_EQ(game.getDirection(), DIR_DOWN);
+}
+
+// Agent tests
+TEST(AgentTest, FactoryKnowsEveryAgent) {
+    DynamicBoard board(6, 6);
+    for (const char* name : {"greedy", "bfs", "hamiltonian"}) {
+        EXPECT_NE(make_agent(name, board), nullptr) << name;
+    }
+    EXPECT_EQ(make_agent("random", board), nullptr);
+}
+
+TEST(AgentTest, BfsTakesAShortestPathToTheFood) {
+    DynamicBoard board(9, 7);
+    for (uint64_t seed = 1; seed <= 10; seed++) {
+        SnakeEngine engine(board, seed);
+        BfsAgent agent(board);
+        // Heading down column 0, so the reversal is blocked by the body anyway.
+        // With the food off that column, the wrapped Manhattan distance is exact.
+        ASSERT_TRUE(engine.placeSnake({{0, 0}, {1, 0}, {2, 0}}, DIR_DOWN));
+        auto head = engine.getHead();
+        auto food = engine.getFood();
+        if (food.second == 0) continue;
+        int dr = std::abs(head.first - food.first);
+        int dc = std::abs(head.second - food.second);
+        int distance = std::min(dr, board.height() - dr) + std::min(dc, board.width() - dc);
+        
+        int ticks = 0;
+        TickResult result = TickResult::Moved;
+        while (result == TickResult::Moved && ticks < 100) {
+            result = engine.step(agent.chooseMove(engine));
+            ticks++;
+        }
+        EXPECT_EQ(result, TickResult::Ate) << "seed " << seed;
+        EXPECT_EQ(ticks, distance) << "seed " << seed;
+    }
+}
+
+TEST(AgentTest, HamiltonianFillsSmallBoards) {
+    EXPECT_TRUE(HamiltonianAgent(DynamicBoard(5, 6)).hasCycle());
+    EXPECT_TRUE(HamiltonianAgent(DynamicBoard(6, 5)).hasCycle());
+    EXPECT_FALSE(HamiltonianAgent(DynamicBoard(5, 5)).hasCycle());
+    
+    DynamicBoard board(6, 6);
+    int wins = 0;
+    size_t longest = 0;
+    for (uint64_t seed = 1; seed <= 20; seed++) {
+        SnakeEngine engine(board, seed);
+        HamiltonianAgent agent(board);
+        int ticks = 0;
+        while (!engine.isOver() && ticks < 20000) {
+            engine.step(agent.chooseMove(engine));
+            ticks++;
+        }
+        wins += engine.isWon();
+        longest = std::max(longest, engine.getSnake().size());
+    }
+    EXPECT_GT(wins, 0);
+    EXPECT_EQ(longest, 36u);
+}
+
+// Arena tests
+static ArenaConfig small_arena(int snakes) {
+    ArenaConfig config;
+    config.width = 8;
+    config.height = 8;
+    config.snakes = snakes;
+    config.food = 0;
+    config.regions = 4;
+    config.respawn = false;
+    return config;
+}
+
+TEST(ArenaTest, HeadOnCollisionKillsBoth) {
+    Arena arena(small_arena(3));
+    ASSERT_TRUE(arena.placeSnake(0, {{2, 0}, {2, 1}}, DIR_RIGHT));
+    ASSERT_TRUE(arena.placeSnake(1, {{2, 4}, {2, 3}}, DIR_LEFT));
+    ASSERT_TRUE(arena.placeSnake(2, {{6, 6}}, DIR_UP));
+    EXPECT_FALSE(arena.placeSnake(2, {{2, 1}}, DIR_UP)); // on snake 0
+    
+    const uint8_t actions[] = {ACTION_RIGHT, ACTION_LEFT, ACTION_UP};
+    arena.step(actions);
+    EXPECT_EQ(arena.lastEvent(0), ArenaEvent::HeadOn);
+    EXPECT_EQ(arena.lastEvent(1), ArenaEvent::HeadOn);
+    EXPECT_EQ(arena.lastEvent(2), ArenaEvent::Moved);
+    EXPECT_FALSE(arena.isAlive(0));
+    EXPECT_FALSE(arena.isAlive(1));
+    for (int col = 0; col < 8; col++) {
+        EXPECT_EQ(arena.ownerAt(2 * 8 + col), -1); // both bodies cleared
+    }
+    EXPECT_EQ(arena.ownerAt(5 * 8 + 6), 2);
+    EXPECT_EQ(arena.stats().headOn, 2);
+}
+
+TEST(ArenaTest, RunningIntoABodyKillsOnlyTheMover) {
+    Arena arena(small_arena(2));
+    ASSERT_TRUE(arena.placeSnake(0, {{3, 1}, {3, 2}, {3, 3}}, DIR_RIGHT));
+    ASSERT_TRUE(arena.placeSnake(1, {{1, 2}, {2, 2}}, DIR_DOWN));
+    
+    const uint8_t actions[] = {ACTION_RIGHT, ACTION_DOWN};
+    arena.step(actions);
+    EXPECT_EQ(arena.lastEvent(0), ArenaEvent::Moved);
+    EXPECT_EQ(arena.lastEvent(1), ArenaEvent::HitBody);
+    EXPECT_EQ(arena.head(0), 3 * 8 + 4);
+    EXPECT_EQ(arena.ownerAt(3 * 8 + 1), -1); // tail moved on
+    EXPECT_EQ(arena.ownerAt(2 * 8 + 2), -1);
+    EXPECT_EQ(arena.stats().hitBody, 1);
+}
+
+TEST(ArenaTest, SameResultWithAnyNumberOfThreads) {
+    ArenaConfig config;
+    config.width = 64;
+    config.height = 48;
+    config.snakes = 120;
+    config.food = 200;
+    config.seed = 9;
+    ThreadPool pool(4);
+    Arena serial(config);
+    Arena parallel(config, &pool);
+    
+    Xoshiro256 rng(1);
+    std::vector<uint8_t> actions(config.snakes);
+    for (int tick = 0; tick < 300; tick++) {
+        for (uint8_t& action : actions) {
+            action = static_cast<uint8_t>(rng.below(4));
+        }
+        serial.step(actions.data());
+        parallel.step(actions.data());
+    }
+    ArenaStats a = serial.stats();
+    ArenaStats b = parallel.stats();
+    EXPECT_EQ(a.eaten, b.eaten);
+    EXPECT_EQ(a.headOn, b.headOn);
+    EXPECT_EQ(a.hitBody, b.hitBody);
+    EXPECT_EQ(a.respawns, b.respawns);
+    EXPECT_GT(a.hitBody + a.headOn, 0);
+    
+    // The grid agrees with the bodies, and food is topped back up
+    int covered = 0;
+    int food = 0;
+    for (int cell = 0; cell < config.width * config.height; cell++) {
+        EXPECT_EQ(serial.ownerAt(cell), parallel.ownerAt(cell));
+        covered += serial.ownerAt(cell) >= 0;
+        food += serial.hasFood(cell);
+    }
+    int lengths = 0;
+    for (int k = 0; k < config.snakes; k++) {
+        lengths += serial.body(k).size();
+    }
+    EXPECT_EQ(covered, lengths);
+    EXPECT_EQ(food, a.food);
+    EXPECT_EQ(food, config.food);
+}
+
+// Protocol tests
+TEST(ProtocolTest, MirrorFollowsArenaThroughDeltas) {
+    ArenaConfig config;
+    config.width = 40;
+    config.height = 30;
+    config.snakes = 60;
+    config.food = 90;
+    config.seed = 5;
+    Arena arena(config);
+    arena.recordChanges(true);
+    std::vector<uint8_t> actions(config.snakes);
+    std::vector<Xoshiro256> rngs(config.snakes);
+    for (int k = 0; k < config.snakes; k++) {
+        rngs[k].reseed(static_cast<uint64_t>(k) + 1);
+    }
+    auto advance = [&]() {
+        for (int k = 0; k < config.snakes; k++) {
+            actions[k] = arena.isAlive(k) ? arena_bot_move(arena, k, rngs[k]) : 0;
+        }
+        arena.step(actions.data());
+    };
+    auto expect_mirrored = [&](const ArenaMirror& mirror) {
+        for (int cell = 0; cell < config.width * config.height; cell++) {
+            int32_t expected = arena.hasFood(cell) ? ARENA_FOOD : arena.ownerAt(cell);
+            ASSERT_EQ(mirror.at(cell), expected) << "cell " << cell;
+        }
+    };
+    for (int tick = 0; tick < 20; tick++) {
+        advance();
+    }
+    
+    // A client joining mid-game gets a snapshot, then a delta per tick
+    std::string stream;
+    encode_welcome(stream, arena, 7);
+    encode_snapshot(stream, arena);
+    ArenaMirror mirror;
+    ASSERT_TRUE(mirror.feed(stream.data(), stream.size()));
+    EXPECT_EQ(mirror.width(), 40);
+    EXPECT_EQ(mirror.height(), 30);
+    EXPECT_EQ(mirror.snakeCount(), 60);
+    EXPECT_EQ(mirror.yourSnake(), 7);
+    expect_mirrored(mirror);
+    
+    size_t deltaBytes = 0;
+    for (int tick = 0; tick < 200; tick++) {
+        advance();
+        stream.clear();
+        encode_delta(stream, arena);
+        deltaBytes += stream.size();
+        // Frames may arrive split at any byte
+        for (size_t pos = 0; pos < stream.size(); pos += 7) {
+            ASSERT_TRUE(mirror.feed(stream.data() + pos, std::min<size_t>(7, stream.size() - pos)));
+        }
+        EXPECT_EQ(mirror.lastTick(), static_cast<uint64_t>(arena.tickCount()));
+    }
+    expect_mirrored(mirror);
+    EXPECT_GT(arena.stats().headOn + arena.stats().hitBody, 0); // deaths and respawns were covered
+    
+    // Deltas stay far smaller than resending the board every tick
+    stream.clear();
+    encode_snapshot(stream, arena);
+    EXPECT_LT(deltaBytes / 200, stream.size());
+    
+    // A delta whose count does not match its length is rejected
+    const char bad[] = {MSG_DELTA, 4, 0, 0, 0, 1, 2, 3, 4};
+    EXPECT_FALSE(ArenaMirror().feed(bad, sizeof(bad)));
+}
+
+// Pacing tests
+TEST(PacingTest, SpeedCurves) {
+    SpeedCurve stepped;
+    EXPECT_EQ(stepped.delayMs(1), BASE_DELAY_MS);
+    EXPECT_EQ(stepped.delayMs(25), BASE_DELAY_MS - 2 * DELAY_REDUCTION_MS);
+    EXPECT_EQ(stepped.delayMs(1000), MIN_DELAY_MS);
+    for (size_t length = 1; length < 200; length++) {
+        EXPECT_EQ(stepped.delayMs(length), delay_for_length(length));
+    }
+    
+    SpeedCurve curve;
+    ASSERT_TRUE(parse_speed_curve("linear:10", curve));
+    EXPECT_EQ(curve.delayMs(1), BASE_DELAY_MS);
+    EXPECT_EQ(curve.delayMs(11), BASE_DELAY_MS - 100);
+    EXPECT_EQ(curve.delayMs(500), MIN_DELAY_MS);
+    
+    ASSERT_TRUE(parse_speed_curve("exp:0.5", curve));
+    EXPECT_EQ(curve.delayMs(1), BASE_DELAY_MS);
+    EXPECT_EQ(curve.delayMs(2), (BASE_DELAY_MS + MIN_DELAY_MS) / 2);
+    EXPECT_EQ(curve.delayMs(100), MIN_DELAY_MS);
+    
+    ASSERT_TRUE(parse_speed_curve("table:1=400,11=200,21=150", curve));
+    EXPECT_EQ(curve.getKind(), SPEED_TABLE);
+    EXPECT_EQ(curve.delayMs(1), 400);
+    EXPECT_EQ(curve.delayMs(6), 300);
+    EXPECT_EQ(curve.delayMs(16), 175);
+    EXPECT_EQ(curve.delayMs(99), 150);
+    
+    // Malformed specs leave the curve as it was
+    for (const char* bad : {"", "fast", "linear:", "linear:-1", "exp:0", "exp:1.5", "table:", "table:5=100,5=90",
+                            "table:1=100,", "table:1:100"}) {
+        EXPECT_FALSE(parse_speed_curve(bad, curve)) << bad;
+    }
+    EXPECT_EQ(curve.delayMs(6), 300);
+}
+
+TEST(PacingTest, TickBudgetHoldsTheRateAndSkipsFramesWhenLate) {
+    const int64_t interval = 100;
+    TickBudget budget;
+    // Work is taken out of the interval, not added to it
+    budget.beginTick(1000);
+    EXPECT_EQ(budget.endTick(1030, interval), 1100);
+    EXPECT_EQ(budget.sleepNs(1030), 70);
+    EXPECT_TRUE(budget.shouldRender());
+    
+    // A tick that overruns the next deadline makes the next one skip drawing
+    budget.beginTick(1100);
+    EXPECT_EQ(budget.endTick(1350, interval), 1200);
+    EXPECT_EQ(budget.sleepNs(1350), 0);
+    EXPECT_FALSE(budget.shouldRender());
+    budget.beginTick(1350);
+    budget.endTick(1360, interval);
+    budget.beginTick(1360);
+    budget.endTick(1370, interval);
+    EXPECT_TRUE(budget.shouldRender()); // caught up by 1400
+    
+    const TickBudgetStats& stats = budget.getStats();
+    EXPECT_EQ(stats.ticks, 4);
+    EXPECT_EQ(stats.missedDeadlines, 2);
+    EXPECT_EQ(stats.skippedFrames, 2);
+    EXPECT_EQ(stats.maxWorkNs, 250);
+    EXPECT_EQ(stats.resyncs, 0);
+    
+    // Hopelessly late ticks stop skipping after MAX_FRAME_SKIP and restart the schedule
+    int64_t now = 1400;
+    for (int i = 0; i <= MAX_FRAME_SKIP; i++) {
+        budget.beginTick(now);
+        now += 10 * interval;
+        budget.endTick(now, interval);
+    }
+    EXPECT_TRUE(budget.shouldRender());
+    EXPECT_EQ(budget.nextDeadline(), now);
+    EXPECT_EQ(stats.resyncs, 1);
+}
+
+// Profile tests
+TEST(ProfileTest, HistogramPercentilesStayWithinOneSlice) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(0.5), 0u);
+    for (int64_t ns = 1; ns <= 100000; ns++) {
+        histogram.record(ns);
+    }
+    histogram.record(-5); // clock hiccups count as zero
+    EXPECT_EQ(histogram.count(), 100001u);
+    EXPECT_EQ(histogram.max(), 100000u);
+    const double tolerance = 1.0 / LatencyHistogram::SUB_BUCKETS;
+    EXPECT_NEAR(histogram.percentile(0.50), 50000.0, 50000.0 * tolerance);
+    EXPECT_NEAR(histogram.percentile(0.99), 99000.0, 99000.0 * tolerance);
+    EXPECT_EQ(histogram.percentile(1.0), 100000u);
+    EXPECT_NEAR(histogram.mean(), 50000.0, 1.0);
+    
+    Profiler profile;
+    profile.record(PROFILE_RENDER, 2500);
+    std::ostringstream json;
+    profile.writeJson(json);
+    EXPECT_EQ(json.str(), "{\"unit\": \"ns\", \"phases\": {\"render\": {\"count\": 1, \"p50\": 2500, "
+                          "\"p90\": 2500, \"p99\": 2500, \"p999\": 2500, \"max\": 2500, \"mean\": 2500}}}\n");
+}
+
+// Snapshot tests
+// A view follows the live body, so a copy is kept to compare against later
+static std::vector<std::pair<int, int>> body_copy(const SnakeEngine& engine) {
+    SnakeView<DynamicBoard> view = engine.getSnake();
+    return std::vector<std::pair<int, int>>(view.begin(), view.end());
+}
+
+TEST(SnapshotTest, RestoredGamePlaysOnIdentically) {
+    SnakeEngine original(DynamicBoard(8, 6), 77);
+    Xoshiro256 rng(4);
+    for (int tick = 0; tick < 40 && !original.isOver(); tick++) {
+        original.step(DIRECTIONS[rng.below(4)]);
+    }
+    std::vector<uint64_t> blob((original.snapshotSize() + 7) / 8);
+    original.snapshot(blob.data());
+    
+    // Restore into an engine that has played a different game
+    SnakeEngine copy(DynamicBoard(8, 6), 1);
+    copy.step(DIR_DOWN);
+    ASSERT_TRUE(copy.restore(blob.data(), original.snapshotSize()));
+    EXPECT_EQ(copy.getSnake(), original.getSnake());
+    EXPECT_EQ(copy.getFood(), original.getFood());
+    EXPECT_EQ(copy.getScore(), original.getScore());
+    
+    // Food placement draws on the restored generator, so the games stay in step
+    for (int tick = 0; tick < 2000 && !original.isOver(); tick++) {
+        char dir = DIRECTIONS[rng.below(4)];
+        ASSERT_EQ(copy.step(dir), original.step(dir));
+        ASSERT_EQ(copy.getFood(), original.getFood());
+        ASSERT_EQ(copy.getPoisonFood(), original.getPoisonFood());
+    }
+    EXPECT_EQ(copy.getSnake(), original.getSnake());
+    EXPECT_EQ(copy.isOver(), original.isOver());
+    EXPECT_EQ(copy.freeCellCount(), original.freeCellCount());
+}
+
+TEST(SnapshotTest, FileRoundTripAndRejects) {
+    const std::string path = "snapshot_test.snks";
+    SnakeEngine engine(DynamicBoard(5, 5), 3);
+    ASSERT_TRUE(engine.placeSnake({{0, 0}, {0, 1}, {0, 2}}, DIR_RIGHT));
+    std::vector<char> blob(engine.snapshotSize());
+    engine.snapshot(blob.data());
+    ASSERT_TRUE(write_snapshot_file(path, blob.data(), blob.size()));
+    
+    SnapshotFile file;
+    ASSERT_TRUE(file.open(path));
+    SnakeEngine loaded(DynamicBoard(5, 5), 9);
+    ASSERT_TRUE(loaded.restore(file.data(), file.size()));
+    EXPECT_EQ(loaded.getSnake(), engine.getSnake());
+    EXPECT_EQ(loaded.getDirection(), DIR_RIGHT);
+    EXPECT_EQ(loaded.getScore(), 20);
+    
+    // Wrong board size or a damaged blob are refused
+    SnakeEngine other(DynamicBoard(5, 4), 9);
+    EXPECT_FALSE(other.restore(file.data(), file.size()));
+    file.close();
+    blob[sizeof(EngineSnapshot)] = 99; // first body cell out of range
+    SnakeEngine damaged(DynamicBoard(5, 5), 9);
+    damaged.step(DIR_DOWN);
+    const auto before = body_copy(damaged);
+    EXPECT_FALSE(damaged.restore(blob.data(), blob.size()));
+    EXPECT_EQ(body_copy(damaged), before); // the live game is kept
+    EXPECT_FALSE(file.open("missing_snapshot.snks"));
+    std::remove(path.c_str());
+}
+
+TEST(SnapshotTest, RejectsMisplacedFood) {
+    SnakeEngine engine(DynamicBoard(5, 5), 3);
+    ASSERT_TRUE(engine.placeSnake({{0, 0}, {0, 1}, {0, 2}}, DIR_RIGHT));
+    std::vector<char> blob(engine.snapshotSize());
+    engine.snapshot(blob.data());
+    EngineSnapshot header;
+    std::memcpy(&header, blob.data(), sizeof(header));
+    const EngineSnapshot good = header;
+    ASSERT_GE(good.food, 0);
+    int32_t body;
+    std::memcpy(&body, blob.data() + sizeof(header), sizeof(body));
+    
+    auto restores = [&](const EngineSnapshot& changed) {
+        std::memcpy(blob.data(), &changed, sizeof(changed));
+        SnakeEngine loaded(DynamicBoard(5, 5), 9);
+        loaded.step(DIR_DOWN);
+        const auto snake = body_copy(loaded);
+        const auto food = loaded.getFood();
+        bool ok = loaded.restore(blob.data(), blob.size());
+        if (!ok) {
+            EXPECT_EQ(body_copy(loaded), snake);
+            EXPECT_EQ(loaded.getFood(), food);
+        }
+        return ok;
+    };
+    EXPECT_TRUE(restores(good));
+    header.food = body; // food on the snake
+    EXPECT_FALSE(restores(header));
+    header = good;
+    header.poison = body;
+    EXPECT_FALSE(restores(header));
+    header = good;
+    header.poison = header.food; // both on one cell
+    EXPECT_FALSE(restores(header));
+    header.food = -1;
+    header.poison = -1;
+    EXPECT_TRUE(restores(header));
+}
+
+// Replay tests
+TEST(ReplayTest, RecordedGameReplaysIdentically) {
+    const std::string path = "replay_test.snkr";
+    SnakeEngine original(DynamicBoard(7, 5), 2024);
+    ReplayHeader header;
+    header.seed = original.getSeed();
+    header.width = 7;
+    header.height = 5;
+    
+    ReplayWriter writer;
+    ASSERT_TRUE(writer.open(path, header));
+    Xoshiro256 rng(3);
+    int ticks = 0;
+    while (!original.isOver() && ticks < 5000) {
+        original.step(DIRECTIONS[rng.below(4)]);
+        writer.record(static_cast<uint8_t>(direction_index(original.getDirection())));
+        ticks++;
+    }
+    writer.close();
+    
+    ReplayReader reader;
+    ASSERT_TRUE(reader.load(path));
+    EXPECT_EQ(reader.header().seed, 2024u);
+    EXPECT_EQ(reader.tickCount(), static_cast<uint64_t>(ticks));
+    
+    SnakeEngine replayed(DynamicBoard(reader.header().width, reader.header().height), reader.header().seed);
+    for (uint8_t dir : reader.directions()) {
+        replayed.step(DIRECTIONS[dir]);
+    }
+    EXPECT_EQ(replayed.getSnake(), original.getSnake());
+    EXPECT_EQ(replayed.getScore(), original.getScore());
+    EXPECT_EQ(replayed.isOver(), original.isOver());
+    std::remove(path.c_str());
+}
+
+TEST(ReplayTest, RejectsForeignFiles) {
+    const std::string path = "not_a_replay.txt";
+    std::ofstream(path) << "250\n150\n";
+    ReplayReader reader;
+    EXPECT_FALSE(reader.load(path));
+    EXPECT_FALSE(reader.load("missing_replay.snkr"));
+    std::remove(path.c_str());
+}
+
+TEST(ReplayTest, RejectsOversizedBoards) {
+    const std::string path = "replay_oversized.snkr";
+    ReplayHeader header;
+    header.width = MAX_BOARD_SIDE;
+    header.height = MAX_BOARD_SIDE + 1;
+    ReplayWriter writer;
+    ASSERT_TRUE(writer.open(path, header));
+    writer.record(0);
+    writer.close();
+    ReplayReader reader;
+    EXPECT_FALSE(reader.load(path));
+
+    header.height = MAX_BOARD_SIDE;
+    ASSERT_TRUE(writer.open(path, header));
+    writer.record(0);
+    writer.close();
+    EXPECT_TRUE(reader.load(path));
+    std::remove(path.c_str());
+}
+
+// Score store tests
+TEST(ScoreStoreTest, KeepsOnlyTheBestScores) {
+    TopScores top(3);
+    for (int score : {50, 10, 70, 30, 90, 20}) {
+        top.insert(score);
+    }
+    EXPECT_EQ(top.size(), 3u);
+    EXPECT_EQ(top.sorted(), std::vector<int>({90, 70, 50}));
+    EXPECT_FALSE(top.insert(40));
+    EXPECT_TRUE(top.insert(60));
+    EXPECT_EQ(top.sorted(), std::vector<int>({90, 70, 60}));
+}
+
+TEST(ScoreStoreTest, CommitMergesWithOtherWriters) {
+    const std::string path = "score_store_test.txt";
+    std::ofstream(path) << "40\n-5\njunk\n";
+
+    // Two instances load the same file, then commit one after the other
+    ScoreStore first(path, 3);
+    ScoreStore second(path, 3);
+    first.load();
+    second.load();
+    EXPECT_EQ(first.top(), std::vector<int>({40}));
+
+    first.add(10);
+    second.add(30);
+    second.add(20);
+    ASSERT_TRUE(first.commit());
+    ASSERT_TRUE(second.commit());
+    EXPECT_EQ(second.top(), std::vector<int>({40, 30, 20}));
+    EXPECT_FALSE(second.hasPending());
+
+    ScoreStore reader(path, 10);
+    reader.load();
+    EXPECT_EQ(reader.top(), std::vector<int>({40, 30, 20}));
+    EXPECT_FALSE(std::ifstream(path + ".tmp").is_open());
+
+    // Nothing pending: the file is left alone
+    std::ofstream(path) << "5\n";
+    ASSERT_TRUE(second.commit());
+    reader.load();
+    EXPECT_EQ(reader.top(), std::vector<int>({5}));
+
+    std::remove(path.c_str());
+    std::remove((path + ".lock").c_str());
+}
+
+// Game log tests
+static GameRecord game_record(uint64_t seed, int32_t score) {
+    GameRecord record = {};
+    record.seed = seed;
+    record.score = score;
+    record.length = score / 10 + 1;
+    record.ticks = seed * 7;
+    record.width = BOARD_SIZE;
+    record.height = BOARD_SIZE;
+    record.result = static_cast<uint8_t>(TickResult::HitSelf);
+    return record;
+}
+
+TEST(GameLogTest, AppendedRecordsMapBackInOrder) {
+    const std::string path = "game_log_test.log";
+    std::remove(path.c_str());
+    GameLog log;
+    EXPECT_FALSE(log.open(path));
+    for (uint64_t i = 0; i < 5; i++) {
+        ASSERT_TRUE(append_game_record(path, game_record(i, static_cast<int32_t>(i * 10))));
+    }
+    ASSERT_TRUE(log.open(path));
+    ASSERT_EQ(log.size(), 5u);
+    EXPECT_EQ(log[3].seed, 3u);
+    EXPECT_EQ(log[3].score, 30);
+    EXPECT_EQ(log[3].ticks, 21u);
+    log.close();
+
+    // A record torn by a crash is hidden from readers and cut off by the next append
+    std::ofstream(path, std::ios::binary | std::ios::app) << "torn";
+    ASSERT_TRUE(log.open(path));
+    EXPECT_EQ(log.size(), 5u);
+    log.close();
+    ASSERT_TRUE(append_game_record(path, game_record(5, 50)));
+    ASSERT_TRUE(log.open(path));
+    ASSERT_EQ(log.size(), 6u);
+    EXPECT_EQ(log[5].seed, 5u);
+    log.close();
+
+    // Foreign files are neither read nor appended to
+    const std::string foreign = "game_log_test.txt";
+    std::ofstream(foreign) << "120\n90\n80\n70\n";
+    EXPECT_FALSE(log.open(foreign));
+    EXPECT_FALSE(append_game_record(foreign, game_record(0, 0)));
+    std::remove(foreign.c_str());
+    std::remove(path.c_str());
+}
+
+TEST(GameLogTest, IndexAnswersTopAndRangeQueries) {
+    const std::string path = "game_index_test.log";
+    std::remove(path.c_str());
+    std::remove(game_index_path(path).c_str());
+    const int32_t scores[] = {30, 90, 10, 90, 50, 70};
+    for (uint64_t i = 0; i < 6; i++) {
+        ASSERT_TRUE(append_game_record(path, game_record(i, scores[i])));
+    }
+    // Without an index the leaderboard comes from a scan of the log
+    EXPECT_EQ(top_game_scores(path, 3), std::vector<int>({90, 90, 70}));
+
+    ASSERT_TRUE(update_game_index(path));
+    GameIndex index;
+    ASSERT_TRUE(index.open(game_index_path(path)));
+    ASSERT_EQ(index.size(), 6u);
+    EXPECT_EQ(index.records(), 6u);
+    // Best first, ties oldest first
+    EXPECT_EQ(index.begin()[0].record, 1u);
+    EXPECT_EQ(index.begin()[1].record, 3u);
+    EXPECT_EQ(index.begin()[5].score, 10);
+    auto range = index.scoreRange(30, 70);
+    ASSERT_EQ(range.second - range.first, 3);
+    EXPECT_EQ(range.first->score, 70);
+    EXPECT_EQ((range.second - 1)->score, 30);
+    range = index.scoreRange(95, 200);
+    EXPECT_EQ(range.first, range.second);
+    index.close();
+
+    // New games count before the index catches up, then get merged into it
+    ASSERT_TRUE(append_game_record(path, game_record(6, 80)));
+    ASSERT_TRUE(append_game_record(path, game_record(7, 90)));
+    EXPECT_EQ(top_game_scores(path, 4), std::vector<int>({90, 90, 90, 80}));
+    ASSERT_TRUE(refresh_game_index(path, 2));
+    ASSERT_TRUE(index.open(game_index_path(path)));
+    EXPECT_EQ(index.records(), 6u);
+    index.close();
+    ASSERT_TRUE(refresh_game_index(path, 1));
+    ASSERT_TRUE(index.open(game_index_path(path)));
+    ASSERT_EQ(index.records(), 8u);
+    EXPECT_EQ(index.begin()[2].record, 7u);
+    EXPECT_EQ(index.begin()[3].score, 80);
+    index.close();
+    EXPECT_EQ(top_game_scores(path, 4), std::vector<int>({90, 90, 90, 80}));
+
+    std::remove(path.c_str());
+    std::remove(game_index_path(path).c_str());
+    std::remove((path + ".lock").c_str());
+}
+
+TEST(GameLogTest, IndexOfARotatedLogIsRebuilt) {
+    const std::string path = "game_rotate_test.log";
+    std::remove(path.c_str());
+    for (uint64_t i = 0; i < 4; i++) {
+        ASSERT_TRUE(append_game_record(path, game_record(i, 100)));
+    }
+    ASSERT_TRUE(update_game_index(path));
+
+    // A new log with more records than the old index covers
+    std::remove(path.c_str());
+    for (uint64_t i = 10; i < 16; i++) {
+        ASSERT_TRUE(append_game_record(path, game_record(i, static_cast<int32_t>(i))));
+    }
+    EXPECT_EQ(top_game_scores(path, 2), std::vector<int>({15, 14}));
+    GameLog log;
+    GameIndex index;
+    ASSERT_TRUE(log.open(path));
+    ASSERT_TRUE(index.open(game_index_path(path)));
+    EXPECT_FALSE(index.builtFrom(log));
+    index.close();
+    ASSERT_TRUE(refresh_game_index(path, GAME_INDEX_LAG));
+    ASSERT_TRUE(index.open(game_index_path(path)));
+    EXPECT_TRUE(index.builtFrom(log));
+    ASSERT_EQ(index.size(), 6u);
+    EXPECT_EQ(index.begin()[0].score, 15);
+    index.close();
+    log.close();
+
+    std::remove(path.c_str());
+    std::remove(game_index_path(path).c_str());
+    std::remove((path + ".lock").c_str());
+}
+
+TEST(GameLogTest, ImportsTheOldLeaderboardOnce) {
+    const std::string path = "game_import_test.log";
+    const std::string scores = "game_import_test.txt";
+    std::remove(path.c_str());
+    std::ofstream(scores) << "120\n90\n80\n70\n";
+    ASSERT_TRUE(import_score_file(path, scores, 3));
+    GameLog log;
+    ASSERT_TRUE(log.open(path));
+    ASSERT_EQ(log.size(), 3u);
+    EXPECT_EQ(log[0].score, 120);
+    EXPECT_EQ(log[2].score, 80);
+    EXPECT_EQ(log[2].result, GAME_RESULT_IMPORTED);
+    log.close();
+
+    // Once the log exists the old file is left alone
+    ASSERT_TRUE(append_game_record(path, game_record(1, 100)));
+    std::ofstream(scores) << "500\n";
+    ASSERT_TRUE(import_score_file(path, scores, 3));
+    EXPECT_EQ(top_game_scores(path, 10), std::vector<int>({120, 100, 90, 80}));
+
+    // No old leaderboard, no log
+    std::remove(path.c_str());
+    std::remove(scores.c_str());
+    ASSERT_TRUE(import_score_file(path, scores, 3));
+    EXPECT_FALSE(log.open(path));
+}
+
+// Thread pool tests
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> visits(10007);
+    for (int round = 0; round < 3; ++round) {
+        pool.parallelFor(static_cast<int64_t>(visits.size()), 16, [&](int64_t begin, int64_t end, unsigned worker) {
+            EXPECT_LT(worker, pool.size());
+            for (int64_t i = begin; i < end; ++i) {
+                visits[i]++;
+            }
+        });
+    }
+    for (auto& count : visits) {
+        EXPECT_EQ(count.load(), 3);
+    }
+}
+
 // Edge case tests
 TEST(SnakeBehaviour, EdgeCaseMovement) {
     // Test movement from all edges
@@ -0,0 +1,86 @@
+#include "snapshot.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool write_snapshot_file(const std::string& path, const void* data, size_t size) {
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        out.flush();
+        if (!out.good()) {
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(temp.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#else
+    std::remove(path.c_str()); // rename does not replace an existing file here
+#endif
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// SnapshotFile class implementation
+bool SnapshotFile::open(const std::string& path) {
+    close();
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    mapped = view;
+    length = static_cast<size_t>(info.st_size);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    copy.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (copy.empty()) {
+        return false;
+    }
+    mapped = copy.data();
+    length = copy.size();
+#endif
+    return true;
+}
+
+void SnapshotFile::close() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapped) {
+        ::munmap(const_cast<void*>(mapped), length);
+    }
+#endif
+    copy.clear();
+    mapped = nullptr;
+    length = 0;
+}
@@ -0,0 +1,71 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Engine snapshot: a flat blob of plain integers in native byte order, the
+// same bytes in memory and on disk, so a file can be mapped and restored
+// from directly. The body and the free-cell list together hold every cell
+// exactly once, so a board of N cells always takes
+// sizeof(EngineSnapshot) + 4 * N bytes.
+//
+//   EngineSnapshot   fixed header below
+//   int32_t[length]  body cell indices, tail first
+//   int32_t[N - length] free cells in the engine's free-list order, which
+//                    food placement depends on
+const uint32_t SNAPSHOT_MAGIC = 0x534b4e53; // "SNKS" when read little-endian
+const uint16_t SNAPSHOT_VERSION = 1;
+const uint16_t SNAPSHOT_OVER = 1;
+const uint16_t SNAPSHOT_WON = 2;
+
+struct EngineSnapshot {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;     // SNAPSHOT_OVER | SNAPSHOT_WON
+    int32_t width;
+    int32_t height;
+    uint64_t seed;
+    uint64_t rng[4];    // generator state, so the game continues exactly
+    int32_t score;
+    int32_t direction;
+    int32_t food;       // cell index, -1 when none
+    int32_t poison;     // cell index, -1 when none
+    int32_t length;     // body segments
+    int32_t reserved;
+};
+static_assert(std::is_trivially_copyable<EngineSnapshot>::value, "snapshots are copied as raw bytes");
+static_assert(sizeof(EngineSnapshot) == 80, "snapshot header layout is part of the file format");
+
+// Bytes a snapshot of a board with this many cells takes
+inline size_t snapshot_size(int cells) {
+    return sizeof(EngineSnapshot) + sizeof(int32_t) * static_cast<size_t>(cells);
+}
+
+// Write a snapshot blob to path. The bytes go to a temp file that is renamed
+// over the old one, so a crash leaves the previous checkpoint intact.
+bool write_snapshot_file(const std::string& path, const void* data, size_t size);
+
+// Read-only view of a snapshot file, mapped into memory where possible
+class SnapshotFile {
+private:
+    const void* mapped;
+    size_t length;
+    std::vector<char> copy; // used where mmap is not available
+
+public:
+    SnapshotFile() : mapped(nullptr), length(0) {}
+    ~SnapshotFile() { close(); }
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    const void* data() const { return mapped; }
+    size_t size() const { return length; }
+};
+
+#endif
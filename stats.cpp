@@ -0,0 +1,166 @@
+#include "engine.h"
+#include "game_log.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+struct StatsConfig {
+    std::string logPath = "games.log";
+    int top = 0;        // > 0 lists the best games
+    bool range = false; // count (and list up to top) games with lo <= score <= hi
+    int32_t lo = 0;
+    int32_t hi = 0;
+    bool reindex = false;
+};
+
+const int RESULT_KINDS = static_cast<int>(TickResult::Won) + 1;
+
+static void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [--log FILE] [--top K] [--range LO:HI] [--reindex]" << std::endl;
+}
+
+static bool parse_args(int argc, char* argv[], StatsConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--reindex") == 0) {
+            config.reindex = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        const char* value = argv[i + 1];
+        if (std::strcmp(argv[i], "--log") == 0) {
+            config.logPath = value;
+        } else if (std::strcmp(argv[i], "--top") == 0) {
+            config.top = std::atoi(value);
+        } else if (std::strcmp(argv[i], "--range") == 0) {
+            char* end = nullptr;
+            config.lo = static_cast<int32_t>(std::strtol(value, &end, 10));
+            if (end == value || *end != ':') return false;
+            const char* second = end + 1;
+            config.hi = static_cast<int32_t>(std::strtol(second, &end, 10));
+            if (end == second || *end != '\0') return false;
+            config.range = true;
+        } else {
+            return false;
+        }
+        ++i;
+    }
+    return config.top >= 0;
+}
+
+static const char* ending_name(uint8_t result) {
+    return result == GAME_RESULT_IMPORTED ? "imported" : tick_result_name(static_cast<TickResult>(result));
+}
+
+// One scan over the mapped records; nothing is parsed or copied
+static void print_summary(const GameLog& log) {
+    uint64_t ticks = 0;
+    int64_t durationMs = 0;
+    int64_t scoreSum = 0;
+    int64_t lengthSum = 0;
+    int32_t best = 0;
+    uint64_t imported = 0;
+    uint64_t results[RESULT_KINDS] = {};
+    for (const GameRecord& record : log) {
+        scoreSum += record.score;
+        best = std::max(best, record.score);
+        // Scores carried over from scores.txt say nothing about how the game went
+        if (record.result == GAME_RESULT_IMPORTED) {
+            imported++;
+            continue;
+        }
+        ticks += record.ticks;
+        durationMs += record.durationMs;
+        lengthSum += record.length;
+        if (record.result < RESULT_KINDS) results[record.result]++;
+    }
+    const double games = static_cast<double>(log.size());
+    const double played = static_cast<double>(log.size() - imported);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "=== Games ===\n";
+    std::cout << "games: " << log.size();
+    if (imported > 0) std::cout << " (" << imported << " imported scores)";
+    std::cout << "\n";
+    if (log.size() == 0) return;
+    std::cout << "best score: " << best << "\n";
+    std::cout << "mean score: " << scoreSum / games << "\n";
+    if (played > 0) {
+        std::cout << "mean length: " << lengthSum / played << "\n";
+        std::cout << "mean ticks: " << ticks / played << "\n";
+        std::cout << "mean duration: " << durationMs / played / 1000.0 << " s\n";
+        std::cout << "total play time: " << durationMs / 3600000.0 << " h\n";
+    }
+
+    std::cout << "\n=== Endings ===\n";
+    for (int i = 0; i < RESULT_KINDS; i++) {
+        if (results[i] == 0) continue;
+        std::cout << std::setw(9) << std::left << ending_name(static_cast<uint8_t>(i)) << std::right << ": "
+                  << results[i] << " (" << 100.0 * results[i] / games << "%)\n";
+    }
+    if (imported > 0) {
+        std::cout << std::setw(9) << std::left << ending_name(GAME_RESULT_IMPORTED) << std::right << ": "
+                  << imported << " (" << 100.0 * imported / games << "%)\n";
+    }
+}
+
+static void print_games(const GameLog& log, const GameIndexEntry* begin, const GameIndexEntry* end) {
+    std::cout << std::fixed;
+    std::cout << "rank  score  length    ticks  seconds  ending     board    seed\n";
+    int rank = 0;
+    for (const GameIndexEntry* entry = begin; entry != end; ++entry) {
+        const GameRecord& record = log[entry->record];
+        std::string board =
+            record.width > 0 ? std::to_string(record.width) + "x" + std::to_string(record.height) : "-";
+        std::cout << std::setw(4) << ++rank << std::setw(7) << record.score << std::setw(8) << record.length
+                  << std::setw(9) << record.ticks << std::setw(9) << std::setprecision(1)
+                  << record.durationMs / 1000.0 << "  " << std::setw(9) << std::left
+                  << ending_name(record.result) << "  " << std::setw(7) << board
+                  << std::right << "  " << record.seed << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    StatsConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Top-K and range queries read the index, so bring it up to date first
+    bool needIndex = config.reindex || config.top > 0 || config.range;
+    if (needIndex && !(config.reindex ? update_game_index(config.logPath) : refresh_game_index(config.logPath, 0))) {
+        std::cerr << "Error: could not index " << config.logPath << std::endl;
+        return 1;
+    }
+    GameLog log;
+    if (!log.open(config.logPath)) {
+        std::cerr << "Error: " << config.logPath << " is not a readable game log" << std::endl;
+        return 1;
+    }
+    if (config.top == 0 && !config.range) {
+        print_summary(log);
+        return 0;
+    }
+
+    GameIndex index;
+    if (!index.open(game_index_path(config.logPath)) || !index.builtFrom(log)) {
+        std::cerr << "Error: could not read the index of " << config.logPath << std::endl;
+        return 1;
+    }
+    const GameIndexEntry* begin = index.begin();
+    const GameIndexEntry* end = index.end();
+    if (config.range) {
+        std::pair<const GameIndexEntry*, const GameIndexEntry*> found = index.scoreRange(config.lo, config.hi);
+        begin = found.first;
+        end = found.second;
+        std::cout << "=== Scores " << config.lo << " to " << config.hi << " ===\n";
+        std::cout << "games: " << end - begin << " of " << index.size() << "\n";
+        if (config.top == 0) return 0;
+    } else {
+        std::cout << "=== Top " << config.top << " ===\n";
+    }
+    if (end - begin > config.top) end = begin + config.top;
+    print_games(log, begin, end);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "thread_pool.h"
+
+// ThreadPool class implementation
+ThreadPool::ThreadPool(unsigned threads)
+    : threadCount(threads == 0 ? 1 : threads), chunkSize(1), generation(0), pending(0), stopping(false) {
+    ranges.reset(new Range[threadCount]);
+    for (unsigned i = 0; i < threadCount; i++) {
+        ranges[i].next.store(0);
+        ranges[i].end = 0;
+    }
+    for (unsigned i = 1; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runShare(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                done.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::runShare(unsigned worker) {
+    // Drain our own range first, then walk the other workers' ranges and steal
+    for (unsigned offset = 0; offset < threadCount; offset++) {
+        Range& range = ranges[(worker + offset) % threadCount];
+        while (true) {
+            int64_t begin = range.next.fetch_add(chunkSize, std::memory_order_relaxed);
+            if (begin >= range.end) break;
+            int64_t end = begin + chunkSize < range.end ? begin + chunkSize : range.end;
+            job(begin, end, worker);
+        }
+    }
+}
+
+void ThreadPool::parallelFor(int64_t count, int64_t chunk,
+                             const std::function<void(int64_t, int64_t, unsigned)>& fn) {
+    if (count <= 0) return;
+
+    chunkSize = chunk > 0 ? chunk : 1;
+    job = fn;
+    int64_t share = (count + threadCount - 1) / threadCount;
+    for (unsigned i = 0; i < threadCount; i++) {
+        int64_t begin = share * i < count ? share * i : count;
+        int64_t end = begin + share < count ? begin + share : count;
+        ranges[i].next.store(begin, std::memory_order_relaxed);
+        ranges[i].end = end;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = threadCount - 1;
+        generation++;
+    }
+    wake.notify_all();
+
+    runShare(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return pending == 0; });
+}
@@ -0,0 +1,56 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops. parallelFor splits the
+// index range evenly across workers; a worker that drains its own share
+// steals chunks from the others, so uneven work (e.g. games of very
+// different lengths) still keeps every core busy.
+class ThreadPool {
+private:
+    // One range per worker, padded so claims on different ranges do not share a cache line
+    struct alignas(64) Range {
+        std::atomic<int64_t> next;
+        int64_t end;
+    };
+
+    std::vector<std::thread> workers;
+    std::unique_ptr<Range[]> ranges;
+    unsigned threadCount;
+    int64_t chunkSize;
+    std::function<void(int64_t, int64_t, unsigned)> job;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation;
+    unsigned pending;
+    bool stopping;
+
+    void workerLoop(unsigned worker);
+    void runShare(unsigned worker);
+
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return threadCount; }
+
+    // Call fn(begin, end, worker) over [0, count) in chunks of at most chunk
+    // indices and return once every chunk has run. The calling thread takes
+    // part as worker 0; worker ids are stable, so fn can index per-worker state.
+    void parallelFor(int64_t count, int64_t chunk, const std::function<void(int64_t, int64_t, unsigned)>& fn);
+};
+
+#endif